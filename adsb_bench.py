@@ -0,0 +1,417 @@
+#!/usr/bin/env python3
+"""
+ADS-B engine micro-benchmarks – the hot paths timed on synthetic traffic.
+
+Each benchmark prints one row per size, numpy kernel next to the scalar
+fallback where the engine has both.  Nothing here touches a radio, the
+sound card or anything past loopback and a pseudo-terminal, where the GPS
+readers meet the replay servers.  Run directly, naming the benchmarks:
+
+    python3 adsb_bench.py gate --targets 50 500 5000
+"""
+import os, json, time, random, tempfile, threading, argparse
+from array import array
+from contextlib import contextmanager, nullcontext
+
+import adsb_engine
+from adsb_engine import (parse_aircraft_json, range_gate, batch_geometry, batch_cpa, GridIndex,
+                         OrbitTracker, ORBIT_TIME_WINDOW, GRID_CELL_DEG, RING_CAUTION_MI,
+                         AudioMixer, NullSink, AudioEngine, AUDIO_RATE,
+                         GpsdClient, NmeaReader)
+from adsb_replay import GpsdReplay, SerialReplay, load_lines, load_serial
+
+MY_LAT, MY_LON = 40.0, -75.0
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "testdata")
+
+
+@contextmanager
+def scalar_path():
+    """Run the engine's kernels without numpy for the duration."""
+    saved, adsb_engine.np = adsb_engine.np, None
+    try:
+        yield
+    finally:
+        adsb_engine.np = saved
+
+
+def _paths():
+    """(name, context) for each kernel path this machine can run."""
+    if adsb_engine.np is not None:
+        yield "numpy", nullcontext
+    yield "scalar", scalar_path
+
+
+def _mean_ms(fn, reps):
+    t0 = time.perf_counter()
+    for _ in range(reps):
+        fn()
+    return (time.perf_counter() - t0) / reps * 1e3
+
+
+def traffic(n, dlat=2.0, dlon=2.6, seed=1):
+    """n aircraft spread uniformly over ±dlat × ±dlon around own-ship."""
+    rnd = random.Random(seed)
+    lats = array("d", (MY_LAT + rnd.uniform(-dlat, dlat) for _ in range(n)))
+    lons = array("d", (MY_LON + rnd.uniform(-dlon, dlon) for _ in range(n)))
+    return lats, lons
+
+
+# ── aircraft.json parse ────────────────────────────────────────────────────────
+
+def aircraft_json(n, seed=1):
+    """A readsb aircraft.json with n entries, a tenth of them without a
+    position and a few on the ground, carrying readsb's other fields too."""
+    rnd = random.Random(seed)
+    lats, lons = traffic(n, seed=seed)
+    entries = []
+    for i in range(n):
+        ac = {"hex": "%06x" % (0xa00000 + i), "type": "adsb_icao",
+              "flight": "N%-7d" % i, "alt_baro": "ground" if i % 50 == 0 else
+              rnd.randrange(0, 40000, 25), "alt_geom": rnd.randrange(0, 40000, 25),
+              "gs": round(rnd.uniform(60, 480), 1), "track": round(rnd.uniform(0, 360), 2),
+              "baro_rate": rnd.randrange(-2000, 2000, 64), "squawk": "1200",
+              "emergency": "none", "category": "A1", "nav_qnh": 1013.6,
+              "nic": 8, "rc": 186, "seen_pos": round(rnd.uniform(0, 5), 1),
+              "version": 2, "nac_p": 9, "nac_v": 1, "sil": 3, "sil_type": "perhour",
+              "mlat": [], "tisb": [], "messages": rnd.randrange(100, 90000),
+              "seen": round(rnd.uniform(0, 5), 1), "rssi": round(rnd.uniform(-30, -5), 1)}
+        if i % 10 != 9:
+            ac["lat"], ac["lon"] = round(lats[i], 6), round(lons[i], 6)
+        entries.append(ac)
+    return json.dumps({"now": 1717243200.0, "messages": 123456, "aircraft": entries}).encode()
+
+
+def _dict_walk(path):
+    """The old loop: json.load, then pick each row's fields out of its dict."""
+    with open(path) as f:
+        data = json.load(f)
+    rows = []
+    for ac in data.get("aircraft", []):
+        hexid, lat, lon = ac.get("hex"), ac.get("lat"), ac.get("lon")
+        if not hexid or lat is None or lon is None:
+            continue
+        alt = ac.get("alt_baro", ac.get("alt_geom"))
+        if alt is None or isinstance(alt, str):
+            continue
+        rows.append(dict(hexid=hexid, lat=lat, lon=lon, alt=alt, track=ac.get("track"),
+                         speed_kts=ac.get("gs"), flight=(ac.get("flight") or "").strip()))
+    return rows
+
+
+def _snapshot(path):
+    with open(path, "rb") as f:
+        return parse_aircraft_json(f.read())
+
+
+@contextmanager
+def stdlib_json():
+    """Parse with json.loads even where orjson is installed."""
+    saved, adsb_engine._json_loads = adsb_engine._json_loads, json.loads
+    try:
+        yield
+    finally:
+        adsb_engine._json_loads = saved
+
+
+def bench_parse(ns, reps=50):
+    """parse_aircraft_json() into a column snapshot against json.load and a
+    per-row dict walk, each reading the file from disk."""
+    paths = [("stdlib", stdlib_json)]
+    if adsb_engine._json_loads is not json.loads:
+        paths.insert(0, ("orjson", nullcontext))
+    print(f"{'n':>6}   json.load+walk   " + "   ".join(f"{name:>6} snapshot" for name, _ in paths))
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "aircraft.json")
+        for n in ns:
+            with open(path, "wb") as fh:
+                fh.write(aircraft_json(n))
+            old = _dict_walk(path)
+            cols = []
+            for _, ctx in paths:
+                with ctx():
+                    assert [r["hexid"] for r in old] == _snapshot(path).hexid
+                    cols.append(f"{_mean_ms(lambda: _snapshot(path), reps):9.2f} ms")
+            print(f"{n:>6}   {_mean_ms(lambda: _dict_walk(path), reps):11.2f} ms   " + "   ".join(cols))
+
+
+# ── Range gate ─────────────────────────────────────────────────────────────────
+
+def bench_gate(ns, rings=(10.0, 3.0), reps=50):
+    """Full batch_geometry against range_gate() plus geometry on survivors."""
+    print(f"{'n':>6} {'ring':>6} {'reject':>7}   " +
+          "   ".join(f"{name} full -> gated" for name, _ in _paths()))
+    for n in ns:
+        lats, lons = traffic(n)
+        for ring in rings:
+            idx = range_gate(lats, lons, MY_LAT, MY_LON, ring)
+            reject = 1 - len(idx) / n if n else 0.0
+            cols = []
+            for _, ctx in _paths():
+                with ctx():
+                    full = _mean_ms(lambda: batch_geometry(lats, lons, MY_LAT, MY_LON), reps)
+                    gated = _mean_ms(lambda: batch_geometry(
+                        lats, lons, MY_LAT, MY_LON,
+                        range_gate(lats, lons, MY_LAT, MY_LON, ring)), reps)
+                cols.append(f"{full:7.2f} -> {gated:5.2f} ms")
+            print(f"{n:>6} {ring:>4.0f}mi {reject:>6.1%}   " + "   ".join(cols))
+
+
+# ── Orbit detection ───────────────────────────────────────────────────────────
+
+def bench_orbit(ns, ticks=30):
+    """Per-tick cost of OrbitTracker with every track's window full, against
+    the deque tracker it replaced (kept as the reference in test_orbit)."""
+    from test_orbit import DequeOrbitTracker
+    print(f"{'tracks':>6}   {'deque':>10}   {'ring':>10}")
+    for n in ns:
+        rnd = random.Random(n)
+        rates = [rnd.uniform(-4, 4) for _ in range(n)]
+        hexids = ["%06x" % k for k in range(n)]
+        old, new = DequeOrbitTracker(), OrbitTracker(n)
+        warm = int(ORBIT_TIME_WINDOW) + 1         # 1 Hz: fill the window first
+        for s in range(warm):
+            for k in range(n):
+                old.update(hexids[k], (rates[k] * s) % 360, float(s))
+                new.update(k, (rates[k] * s) % 360, float(s))
+        cost = []
+        for tracker, keys in ((old, hexids), (new, range(n))):
+            t0 = time.perf_counter()
+            for s in range(warm, warm + ticks):
+                for k, key in enumerate(keys):
+                    tracker.update(key, (rates[k] * s) % 360, float(s))
+            cost.append((time.perf_counter() - t0) / ticks * 1e3)
+        print(f"{n:>6}   {cost[0]:7.2f} ms   {cost[1]:7.2f} ms")
+
+
+# ── Closest approach ───────────────────────────────────────────────────────────
+
+def bench_cpa(ns, reps=50):
+    """batch_cpa() over gated traffic with a relative velocity per row."""
+    print(f"{'n':>6}   " + "   ".join(f"{name:>9}" for name, _ in _paths()))
+    for n in ns:
+        rnd = random.Random(n)
+        col = lambda lo, hi: array("d", (rnd.uniform(lo, hi) for _ in range(n)))
+        dist, bear = col(0.1, 10.0), col(0.0, 360.0)
+        vx, vy = col(-0.06, 0.06), col(-0.06, 0.06)
+        agl, vrate = col(0.0, 5000.0), col(-2000.0, 2000.0)
+        cells = []
+        for _, ctx in _paths():
+            with ctx():
+                ms = _mean_ms(lambda: batch_cpa(dist, bear, vx, vy, agl, vrate,
+                                                RING_CAUTION_MI), reps)
+            cells.append(f"{ms:6.2f} ms")
+        print(f"{n:>6}   " + "   ".join(cells))
+
+
+# ── Spatial index ──────────────────────────────────────────────────────────────
+
+def bench_grid(n=5000, queries=300, ring=3.0):
+    """GridIndex build and query against the linear range gate, and a radar
+    click hit-test against a scan of every drawn position."""
+    lats, lons = traffic(n, dlat=6.0, dlon=8.0)
+    rnd = random.Random(2)
+    sites = [(MY_LAT + rnd.uniform(-6, 6), MY_LON + rnd.uniform(-8, 8)) for _ in range(queries)]
+    print(f"{n} aircraft over 12 x 16 deg, {ring:.0f} mi gate, {queries} own-ship positions")
+    for name, ctx in _paths():
+        with ctx():
+            build = _mean_ms(lambda: GridIndex(lons, lats, GRID_CELL_DEG), 20)
+            grid = GridIndex(lons, lats, GRID_CELL_DEG)
+            t0 = time.perf_counter()
+            for la, lo in sites:
+                range_gate(lats, lons, la, lo, ring)
+            t1 = time.perf_counter()
+            for la, lo in sites:
+                range_gate(lats, lons, la, lo, ring, grid)
+            t2 = time.perf_counter()
+        print(f"  {name:>6}: build {build * 1e3:7.0f} us   linear {(t1 - t0) / queries * 1e6:6.0f} us"
+              f"   grid {(t2 - t1) / queries * 1e6:6.0f} us")
+    # Radar click: n targets drawn on an 800 px scope, 18 px hit radius.
+    r = 18
+    xs = array("d", (rnd.uniform(0, 800) for _ in range(n)))
+    ys = array("d", (rnd.uniform(0, 800) for _ in range(n)))
+    clicks = [(rnd.uniform(0, 800), rnd.uniform(0, 800)) for _ in range(queries)]
+
+    def scan(x, y):
+        best, best_d = None, r
+        for k in range(n):
+            d = ((xs[k] - x) ** 2 + (ys[k] - y) ** 2) ** 0.5
+            if d <= best_d:
+                best, best_d = k, d
+        return best
+
+    def hit(grid, x, y):
+        best, best_d = None, r
+        for k in grid.query(x - r, y - r, x + r, y + r):
+            d = ((xs[k] - x) ** 2 + (ys[k] - y) ** 2) ** 0.5
+            if d <= best_d:
+                best, best_d = k, d
+        return best
+    grid = GridIndex(xs, ys, r)
+    t0 = time.perf_counter()
+    for x, y in clicks[:20]:
+        scan(x, y)
+    t1 = time.perf_counter()
+    for x, y in clicks:
+        hit(grid, x, y)
+    t2 = time.perf_counter()
+    print(f"  click: scan {(t1 - t0) / 20 * 1e3:6.2f} ms   grid {(t2 - t1) / queries * 1e6:6.0f} us")
+
+
+# ── Alert audio ────────────────────────────────────────────────────────────────
+
+class _ClockSink(NullSink):
+    """NullSink that notes when each clip's first sample reaches the sink.
+
+    Clips are constant-valued so a block's owner can be read off its
+    samples.  The sink is modelled as a device playing at AUDIO_RATE that
+    restarts whenever a write finds it drained, so a sample's heard time
+    follows from how much audio was already queued ahead of it.
+    """
+
+    def __init__(self):
+        super().__init__()
+        self.t0 = None
+        self.play_end = 0.0         # when the device runs out of queued audio
+        self.first = {}             # sample value -> (write time, heard time)
+
+    def write(self, pcm):
+        now = time.perf_counter()
+        if self.t0 is None:
+            self.t0 = now
+        start = max(self.play_end, now)
+        samples = array("h", pcm)
+        for i, x in enumerate(samples):
+            if x and x not in self.first:
+                self.first[x] = (now, start + i / AUDIO_RATE)
+        self.play_end = start + len(samples) / AUDIO_RATE
+        return super().write(pcm)
+
+
+def _clip(value, sec):
+    return array("h", [value]).tobytes() * int(AUDIO_RATE * sec)
+
+
+def _pct(xs, p):
+    xs = sorted(xs)
+    return xs[min(len(xs) - 1, int(p * len(xs)))]
+
+
+def bench_mixer(trials=20):
+    """Trigger-to-sink latency on an idle mixer, and how soon a DANGER is
+    heard when it arrives during a CAUTION sentence, over a null sink."""
+    prio = AudioEngine.PRIORITY
+    idle, cut, heard = [], [], []
+    held = 0
+    for _ in range(trials):
+        sink = _ClockSink()
+        mixer = AudioMixer(sink)
+        time.sleep(0.01)
+        t_sub = time.perf_counter()
+        mixer.play(_clip(1000, 0.1), prio["caution"], "tone", t_sub)
+        time.sleep(0.15)
+        idle.append((sink.first[1000][0] - t_sub) * 1e3)
+
+        # A 2 s CAUTION sentence, then DANGER speech 300 ms into it.
+        mixer.play(_clip(2000, 2.0), prio["caution"], "speech")
+        time.sleep(0.3)
+        t_sub = time.perf_counter()
+        mixer.play(_clip(3000, 0.5), prio["danger"], "speech", t_sub)
+        # A CAUTION during the DANGER must queue, not cut in.
+        time.sleep(0.1)
+        mixer.play(_clip(4000, 0.2), prio["caution"], "speech")
+        time.sleep(0.3)
+        write_t, heard_t = sink.first[3000]
+        cut.append((write_t - t_sub) * 1e3)
+        heard.append((heard_t - t_sub) * 1e3)
+        held += 4000 not in sink.first
+        mixer.stop()
+    print(f"idle tone, submit to sink   p50 {_pct(idle, .5):6.2f} ms  p95 {_pct(idle, .95):6.2f} ms")
+    print(f"DANGER over CAUTION speech  to sink p50 {_pct(cut, .5):6.2f} ms  "
+          f"heard p50 {_pct(heard, .5):6.2f} ms  p95 {_pct(heard, .95):6.2f} ms")
+    print(f"CAUTION during DANGER held back in {held}/{trials} trials")
+
+    # Streaming pace: a 2 s clip should take ~2 s less the lead to hand over.
+    sink = _ClockSink()
+    mixer = AudioMixer(sink)
+    mixer.play(_clip(5000, 2.0), prio["caution"], "speech")
+    while sink.bytes_written < 2 * int(AUDIO_RATE * 2.0):
+        time.sleep(0.005)
+    print(f"2 s clip streamed over {time.perf_counter() - sink.t0:5.2f} s")
+    mixer.stop()
+
+
+# ── GPS first fix ──────────────────────────────────────────────────────────────
+
+def _first_fix_ms(make_source, make_reader):
+    """Start a reader against a fresh source and time its first good fix."""
+    src = make_source().start()
+    got = threading.Event()
+    reader = make_reader(src, lambda fix: fix and got.set())
+    t0 = time.perf_counter()
+    threading.Thread(target=reader.run, daemon=True).start()
+    ok = got.wait(5.0)
+    ms = (time.perf_counter() - t0) * 1e3
+    reader.stop()
+    src.stop()
+    return ms if ok else None
+
+
+class _EagerSerial(SerialReplay):
+    POLL_SEC = 0.0005                   # notice the open at once, like a live receiver
+
+
+def bench_first_fix(trials=20):
+    """Reader start to first fix: gpsd's socket against the receiver's own
+    serial port, each fed a capture that opens with a no-fix epoch.
+
+    The captures are sent unpaced, so this is the path's own cost (connect
+    and ?WATCH, or open and raw termios, then parsing) without the wait
+    for the receiver's next solution, which both paths share.  Starting
+    gpsd itself (fix_gps_setup, up to 15 s) is not included.
+    """
+    gpsd = load_lines(os.path.join(DATA, "gpsd_capture.json"))
+    nmea = load_serial(os.path.join(DATA, "gps_capture.nmea"))
+    ubx = load_serial(os.path.join(DATA, "gps_capture.ubx"))
+    paths = (
+        ("gpsd JSON over TCP", lambda: GpsdReplay(gpsd, speed=0),
+         lambda s, cb: GpsdClient(cb, s.host, s.port)),
+        ("serial NMEA on a pty", lambda: _EagerSerial(nmea, speed=0),
+         lambda s, cb: NmeaReader(cb, s.device, 9600)),
+        ("serial UBX on a pty", lambda: _EagerSerial(ubx, speed=0),
+         lambda s, cb: NmeaReader(cb, s.device, 9600, ubx=True)),
+    )
+    for name, make_source, make_reader in paths:
+        runs = [_first_fix_ms(make_source, make_reader) for _ in range(trials)]
+        ms = [r for r in runs if r is not None]
+        if not ms:
+            print(f"{name:22s} no fix")
+            continue
+        print(f"{name:22s} first fix p50 {_pct(ms, .5):7.2f} ms  p95 {_pct(ms, .95):7.2f} ms"
+              f"  ({len(ms)}/{trials})")
+
+
+BENCHES = {
+    "parse": lambda a: bench_parse(a.targets),
+    "gate":  lambda a: bench_gate(a.targets),
+    "orbit": lambda a: bench_orbit(a.tracks),
+    "grid":  lambda a: bench_grid(max(a.targets)),
+    "cpa":   lambda a: bench_cpa(a.targets),
+    "mixer": lambda a: bench_mixer(),
+    "first_fix": lambda a: bench_first_fix(),
+}
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="ADS-B engine micro-benchmarks")
+    parser.add_argument("bench", nargs="*",
+                        help=f"benchmarks to run: {', '.join(sorted(BENCHES))} (default: all)")
+    parser.add_argument("--targets", type=int, nargs="+", default=[50, 500, 5000],
+                        help="aircraft per snapshot")
+    parser.add_argument("--tracks", type=int, nargs="+", default=[100, 1000],
+                        help="tracks with a full orbit window")
+    args = parser.parse_args()
+    unknown = set(args.bench) - set(BENCHES)
+    if unknown:
+        parser.error(f"unknown benchmark: {', '.join(sorted(unknown))}")
+    for name in args.bench or sorted(BENCHES):
+        print(f"── {name} " + "─" * (60 - len(name)))
+        BENCHES[name](args)
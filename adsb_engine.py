@@ -0,0 +1,3338 @@
+#!/usr/bin/env python3
+"""
+ADS-B alert engine – ingest, threat classification and alerting.
+
+Imports no GUI toolkit: run it directly for a headless daemon that serves
+snapshots to any number of adsb_alert.py displays, or let the display
+run it in-process.
+"""
+import json, time, math, os, socket, threading, subprocess, argparse, zlib
+import calendar, ctypes, heapq, io, mmap, select, selectors, signal, struct, termios, wave
+from array import array
+from dataclasses import dataclass
+from typing import Optional
+from datetime import datetime
+from collections import deque, OrderedDict
+
+try:
+    import orjson                      # native SIMD parser when installed
+    _json_loads = orjson.loads
+except ImportError:
+    _json_loads = json.loads
+
+try:
+    import numpy as np                 # vectorised batch geometry when installed
+except ImportError:
+    np = None
+
+# ── Constants ──────────────────────────────────────────────────────────────────
+AIRCRAFT_JSON        = "/run/readsb/aircraft.json"
+RING_CAUTION_MI      = 3.0
+RING_WARN_MI         = 1.0
+RING_DANGER_MI       = 0.4
+MAX_ALT_FT           = 1000
+MIN_CLOSING_MPH      = 5
+WARN_COOLDOWN_SEC    = 25
+DANGER_COOLDOWN_SEC  = 4
+ORBIT_COOLDOWN_SEC   = 60
+SAMPLE_SEC           = 1.0
+FIELD_ELEV_FT        = 0
+GPS_DEVICE           = "/dev/ttyAMA0"
+GPS_SOURCE           = "gpsd"          # "gpsd", or "serial" to read GPS_DEVICE directly
+GPS_BAUD             = 9600
+GPS_UBX              = False           # also enable and decode u-blox NAV-PVT
+ORBIT_HEADING_THRESHOLD  = 270
+ORBIT_TIME_WINDOW        = 120
+ORBIT_MIN_TURN_RATE_DPS  = 1.5   # deg/s — filters slow heading drift from true orbits
+ORBIT_MIN_SAMPLE_SEC     = 0.5   # decimate faster (pushed) headings to fit the ring
+TRACK_STORE_MAX      = 2048            # per-aircraft state records — hard memory cap
+TRACK_STATE_TTL_SEC  = ORBIT_TIME_WINDOW   # no state is useful once the window has passed
+REG_DB_PATH          = "/etc/adsb-alert/reg.json"
+INGEST_MODE          = "json"          # "json" polls AIRCRAFT_JSON, "sbs" streams
+SBS_HOST             = "127.0.0.1"
+SBS_PORT             = 30003
+SBS_POSITION_MAX_AGE = 60              # s — readsb drops older positions from its JSON too
+SBS_TRACK_EXPIRE_SEC = 300
+PUSH_MIN_INTERVAL_SEC = 0.2            # floor between push-driven updates
+GPS_STALE_SEC        = 5.0             # no TPV fix for this long counts as lost
+GPS_MIN_SPEED_MPS    = 1.0             # slower than this, own-ship is parked
+ENGINE_SOCKET        = os.path.join(os.environ.get("XDG_RUNTIME_DIR", "/tmp"),
+                                    "adsb-alert.sock")
+CLIENT_MAX_BACKLOG   = 1 << 20         # unsent bytes before a display client is dropped
+SHM_BUS_PATH         = "/dev/shm/adsb-alert"
+BUS_FRAMES           = 8               # snapshot frames in the shared-memory ring
+BUS_MAX_RECORDS      = 1024            # aircraft per frame; the farthest are cut
+BUS_POLL_SEC         = 0.05
+BUS_STALE_SEC        = 5.0             # no new frame this long: the engine is gone
+AUDIO_RATE           = 22050           # Hz, mono s16le for every alert sound
+AUDIO_SINK           = "player"        # "player", "null" or a raw PCM file path
+MIXER_BLOCK_MS       = 20
+MIXER_LEAD_MS        = 40              # how far the mixer may run ahead of the sink
+MIXER_QUEUE_MAX      = 2               # clips waiting per channel
+PHRASE_IDENT_CACHE   = 256             # synthesized idents kept for reuse
+KF_POS_SIGMA_MI      = 0.03            # ADS-B position noise (≈ NACp 8)
+KF_VEL_SIGMA_MPH     = 5               # gs/track velocity noise
+KF_ACCEL_SIGMA_MPH_S = 5               # manoeuvre noise, mph gained per second
+KF_INIT_VEL_SIGMA_MPH = 300            # first contact without gs/track
+KF_RESET_GAP_SEC     = 30              # restart the filter after a longer data gap
+KF_CONFIDENCE_Z      = 1.0             # closing must clear MIN_CLOSING_MPH by this many sigma
+CPA_LOOKAHEAD_SEC    = 180             # ignore closest approaches further out than this
+PREDICT_FRAME_SEC    = 1 / 30          # dead-reckoned radar frames and DANGER checks
+PREDICT_MAX_SEC      = 5.0             # never dead-reckon further past a report than this
+GRID_CELL_DEG        = 0.05            # spatial index bucket, ~3.5 mi of latitude
+CLOCK_OFFSET_WINDOW_SEC = 60           # readsb-to-local offset is the least seen this long
+
+COMPASS_POINTS = [
+    "N", "NNE", "NE", "ENE", "E", "ESE", "SE", "SSE",
+    "S", "SSW", "SW", "WSW", "W", "WNW", "NW", "NNW",
+]
+
+# ── Math helpers ───────────────────────────────────────────────────────────────
+EARTH_RADIUS_MI = 3958.8
+MI_PER_DEG      = EARTH_RADIUS_MI * math.pi / 180
+MPH_PER_KT      = 1.150779
+MPH_PER_MPS     = 2.236936
+
+
+def haversine_miles(lat1, lon1, lat2, lon2):
+    R = EARTH_RADIUS_MI
+    dlat = math.radians(lat2 - lat1)
+    dlon = math.radians(lon2 - lon1)
+    a = (math.sin(dlat / 2) ** 2 +
+         math.cos(math.radians(lat1)) * math.cos(math.radians(lat2)) *
+         math.sin(dlon / 2) ** 2)
+    return R * 2 * math.asin(math.sqrt(a))
+
+
+def bearing_deg(lat1, lon1, lat2, lon2):
+    dlon = math.radians(lon2 - lon1)
+    lat1r, lat2r = math.radians(lat1), math.radians(lat2)
+    x = math.sin(dlon) * math.cos(lat2r)
+    y = (math.cos(lat1r) * math.sin(lat2r) -
+         math.sin(lat1r) * math.cos(lat2r) * math.cos(dlon))
+    return (math.degrees(math.atan2(x, y)) + 360) % 360
+
+
+def range_gate(lats, lons, my_lat, my_lon, max_mi, grid=None):
+    """Indices of aircraft that may lie within max_mi of own-ship.
+
+    A cheap pre-filter on raw degrees so exact great-circle math is only
+    paid for survivors.  The box is conservative: a great-circle distance d
+    bounds |dlat| by d/R and |dlon| by asin(sin(d/R) / cos(my_lat)), so no
+    aircraft inside the circle is ever rejected.  With a GridIndex over the
+    same columns only the buckets under the box are examined; the result
+    is identical either way.
+    """
+    ang = max_mi / EARTH_RADIUS_MI
+    max_dlat = math.degrees(ang) * 1.0001
+    cos_me = math.cos(math.radians(my_lat))
+    if cos_me <= math.sin(ang):
+        max_dlon = 180.0  # circle reaches over a pole — any longitude can match
+    else:
+        max_dlon = math.degrees(math.asin(math.sin(ang) / cos_me)) * 1.0001
+    lat_lo, lat_hi = my_lat - max_dlat, my_lat + max_dlat
+    if grid is not None:
+        return _grid_gate(grid, lats, lons, my_lon, lat_lo, lat_hi, max_dlon)
+    if np is not None and len(lats):
+        lat = np.frombuffer(lats, dtype=np.float64)
+        dlon = (np.frombuffer(lons, dtype=np.float64) - my_lon + 540.0) % 360.0 - 180.0
+        return np.flatnonzero((lat >= lat_lo) & (lat <= lat_hi) &
+                              (np.abs(dlon) <= max_dlon))
+    return array("l", [i for i, (lat, lon) in enumerate(zip(lats, lons))
+                       if lat_lo <= lat <= lat_hi
+                       and abs((lon - my_lon + 540.0) % 360.0 - 180.0) <= max_dlon])
+
+
+def _grid_gate(grid, lats, lons, my_lon, lat_lo, lat_hi, max_dlon):
+    lon_lo, lon_hi = my_lon - max_dlon, my_lon + max_dlon
+    if max_dlon >= 180.0:
+        windows = ((-180.0, 180.0),)
+    elif lon_lo < -180.0:
+        windows = ((lon_lo + 360.0, 180.0), (-180.0, lon_hi))
+    elif lon_hi > 180.0:
+        windows = ((lon_lo, 180.0), (-180.0, lon_hi - 360.0))
+    else:
+        windows = ((lon_lo, lon_hi),)
+    if np is not None:
+        idx = np.concatenate([grid.query(a, lat_lo, b, lat_hi) for a, b in windows])
+        lat = np.frombuffer(lats, dtype=np.float64)[idx]
+        dlon = (np.frombuffer(lons, dtype=np.float64)[idx] - my_lon + 540.0) % 360.0 - 180.0
+        return np.sort(idx[(lat >= lat_lo) & (lat <= lat_hi) & (np.abs(dlon) <= max_dlon)])
+    idx = array("l")
+    for a, b in windows:
+        idx.extend(grid.query(a, lat_lo, b, lat_hi))
+    return array("l", sorted(i for i in idx
+                             if lat_lo <= lats[i] <= lat_hi
+                             and abs((lons[i] - my_lon + 540.0) % 360.0 - 180.0) <= max_dlon))
+
+
+class GridIndex:
+    """Uniform grid over 2-D points for box queries in sub-linear time.
+
+    Points are bucketed by (floor(y / cell), floor(x / cell)); a query only
+    visits the buckets its box overlaps, so the cost follows the number of
+    points near the box rather than the total.  Built once from coordinate
+    columns — lon/lat degrees for a snapshot, pixels for the radar — and
+    immutable afterwards.  With numpy the buckets are one sorted key array
+    searched per grid row; without it, a dict of index arrays.  NaN points
+    are left out.  Query results are the ids passed in (default: position
+    in the columns), unordered, and only bucket-accurate: callers still
+    test the exact shape they want.
+    """
+    _BIAS = 1 << 20             # keeps cell coordinates positive in the key
+
+    def __init__(self, xs, ys, cell, ids=None):
+        self.cell = cell
+        if np is not None:
+            x = np.asarray(xs, dtype=np.float64)
+            y = np.asarray(ys, dtype=np.float64)
+            ids = np.arange(len(x)) if ids is None else np.asarray(ids)
+            ok = ~(np.isnan(x) | np.isnan(y))
+            keys = self._key(np.floor(y[ok] / cell).astype(np.int64),
+                             np.floor(x[ok] / cell).astype(np.int64))
+            order = np.argsort(keys, kind="stable")
+            self._keys = keys[order]
+            self._ids = ids[ok][order]
+            return
+        self._buckets = {}
+        for n, (x, y) in enumerate(zip(xs, ys)):
+            if x != x or y != y:
+                continue
+            key = (math.floor(y / cell), math.floor(x / cell))
+            bucket = self._buckets.get(key)
+            if bucket is None:
+                bucket = self._buckets[key] = array("l")
+            bucket.append(n if ids is None else ids[n])
+
+    @classmethod
+    def _key(cls, row, col):
+        return (row + cls._BIAS) * (cls._BIAS << 1) + (col + cls._BIAS)
+
+    def query(self, x0, y0, x1, y1):
+        """Ids of points in buckets overlapping the box [x0, x1] × [y0, y1]."""
+        c0, c1 = math.floor(x0 / self.cell), math.floor(x1 / self.cell)
+        r0, r1 = math.floor(y0 / self.cell), math.floor(y1 / self.cell)
+        if np is not None:
+            keys = self._keys
+            lo = np.searchsorted(keys, [self._key(r, c0) for r in range(r0, r1 + 1)], "left")
+            hi = np.searchsorted(keys, [self._key(r, c1) for r in range(r0, r1 + 1)], "right")
+            spans = [self._ids[a:b] for a, b in zip(lo.tolist(), hi.tolist()) if b > a]
+            if not spans:
+                return self._ids[:0]
+            return spans[0] if len(spans) == 1 else np.concatenate(spans)
+        out = array("l")
+        buckets = self._buckets
+        if (r1 - r0 + 1) * (c1 - c0 + 1) > len(buckets):
+            for (r, c), bucket in buckets.items():   # box wider than the data
+                if r0 <= r <= r1 and c0 <= c <= c1:
+                    out.extend(bucket)
+            return out
+        for r in range(r0, r1 + 1):
+            for c in range(c0, c1 + 1):
+                bucket = buckets.get((r, c))
+                if bucket is not None:
+                    out.extend(bucket)
+        return out
+
+
+def batch_geometry(lats, lons, my_lat, my_lon, idx=None):
+    """Distance, bearing-from-me and bearing-to-me for a whole snapshot.
+
+    Equivalent to haversine_miles(me, ac), bearing_deg(me, ac) and
+    bearing_deg(ac, me) per aircraft, but the own-ship trig is computed once
+    and the per-aircraft sin/cos terms are shared by all three results.
+    Takes the snapshot's lat/lon columns and, optionally, the indices from
+    range_gate() to restrict the work to; results are in idx order.  Uses
+    numpy when available and a scalar loop otherwise.
+    """
+    my_latr = math.radians(my_lat)
+    sin_me, cos_me = math.sin(my_latr), math.cos(my_latr)
+    if np is not None and len(lats):
+        lat = np.frombuffer(lats, dtype=np.float64)
+        lon = np.frombuffer(lons, dtype=np.float64)
+        if idx is not None:
+            lat, lon = lat[idx], lon[idx]
+        latr = np.radians(lat)
+        dlon = np.radians(lon - my_lon)
+        sin_lat, cos_lat = np.sin(latr), np.cos(latr)
+        sin_dlon, cos_dlon = np.sin(dlon), np.cos(dlon)
+        a = (np.sin((latr - my_latr) / 2) ** 2 +
+             cos_me * cos_lat * np.sin(dlon / 2) ** 2)
+        dist = 2 * EARTH_RADIUS_MI * np.arcsin(np.sqrt(np.minimum(a, 1.0)))
+        bear = np.degrees(np.arctan2(sin_dlon * cos_lat,
+                                     cos_me * sin_lat - sin_me * cos_lat * cos_dlon))
+        to_me = np.degrees(np.arctan2(-sin_dlon * cos_me,
+                                      cos_lat * sin_me - sin_lat * cos_me * cos_dlon))
+        return dist, (bear + 360) % 360, (to_me + 360) % 360
+
+    sin, cos, asin, atan2, sqrt = math.sin, math.cos, math.asin, math.atan2, math.sqrt
+    rad, deg = math.radians, math.degrees
+    dist, bear, to_me = array("d"), array("d"), array("d")
+    for i in (range(len(lats)) if idx is None else idx):
+        latr = rad(lats[i])
+        dlon = rad(lons[i] - my_lon)
+        sin_lat, cos_lat = sin(latr), cos(latr)
+        sin_dlon, cos_dlon = sin(dlon), cos(dlon)
+        a = (sin((latr - my_latr) / 2) ** 2 +
+             cos_me * cos_lat * sin(dlon / 2) ** 2)
+        dist.append(2 * EARTH_RADIUS_MI * asin(sqrt(min(a, 1.0))))
+        bear.append((deg(atan2(sin_dlon * cos_lat,
+                               cos_me * sin_lat - sin_me * cos_lat * cos_dlon)) + 360) % 360)
+        to_me.append((deg(atan2(-sin_dlon * cos_me,
+                                cos_lat * sin_me - sin_lat * cos_me * cos_dlon)) + 360) % 360)
+    return dist, bear, to_me
+
+
+def observer_matrix(lats, lons, obs_lats, obs_lons, idx=None):
+    """Distance and bearing from every observer to every aircraft.
+
+    The fleet form of batch_geometry(): row o of each result holds observer
+    o's distances (mi) and bearings (deg) to the aircraft in idx order, so
+    N sites cost one broadcast pass instead of N.  Uses numpy when
+    available and one batch_geometry() call per observer otherwise.
+    """
+    if np is None:
+        rows = [batch_geometry(lats, lons, la, lo, idx) for la, lo in zip(obs_lats, obs_lons)]
+        return [r[0] for r in rows], [r[1] for r in rows]
+    lat = np.frombuffer(lats, dtype=np.float64)
+    lon = np.frombuffer(lons, dtype=np.float64)
+    if idx is not None:
+        lat, lon = lat[idx], lon[idx]
+    latr = np.radians(lat)[None, :]
+    o_latr = np.radians(np.asarray(obs_lats, dtype=np.float64))[:, None]
+    dlon = np.radians(lon[None, :] - np.asarray(obs_lons, dtype=np.float64)[:, None])
+    sin_lat, cos_lat = np.sin(latr), np.cos(latr)
+    sin_o, cos_o = np.sin(o_latr), np.cos(o_latr)
+    a = np.sin((latr - o_latr) / 2) ** 2 + cos_o * cos_lat * np.sin(dlon / 2) ** 2
+    dist = 2 * EARTH_RADIUS_MI * np.arcsin(np.sqrt(np.minimum(a, 1.0)))
+    bear = np.degrees(np.arctan2(np.sin(dlon) * cos_lat,
+                                 cos_o * sin_lat - sin_o * cos_lat * np.cos(dlon)))
+    return dist, (bear + 360) % 360
+
+
+def predict_positions(table, slots, t):
+    """Dead-reckoned position of table rows at epoch t (time.time()).
+
+    Each row holds its reported position relative to own-ship (rx/ry, mi
+    east/north) at pos_t and its velocity relative to own-ship from gs and
+    track (vx/vy, mi/s, NaN if unknown); rows without one hold still.  No
+    row is carried more than PREDICT_MAX_SEC past its report, so a stalled
+    feed cannot fling traffic across the scope.  Returns (east, north) in
+    slots order.  Uses numpy when available and a scalar loop otherwise.
+    """
+    if np is not None and len(slots):
+        idx = np.asarray(slots, dtype=np.intp)
+        col = lambda name: np.frombuffer(getattr(table, name), dtype=np.float64)[idx]
+        dt = np.clip(t - col("pos_t"), 0.0, PREDICT_MAX_SEC)
+        vx, vy = np.nan_to_num(col("vx")), np.nan_to_num(col("vy"))
+        return col("rx") + vx * dt, col("ry") + vy * dt
+
+    east, north = array("d"), array("d")
+    rx, ry, vx, vy, pos_t = table.rx, table.ry, table.vx, table.vy, table.pos_t
+    for slot in slots:
+        dt = min(max(t - pos_t[slot], 0.0), PREDICT_MAX_SEC)
+        x, y = rx[slot], ry[slot]
+        if vx[slot] == vx[slot]:
+            x += vx[slot] * dt
+            y += vy[slot] * dt
+        east.append(x)
+        north.append(y)
+    return east, north
+
+
+def batch_cpa(dist, bear, vx, vy, agl, vrate, ring_mi):
+    """Closest point of approach of every aircraft to own-ship.
+
+    Relative position comes from the range/bearing columns (mi, deg) and
+    velocity relative to own-ship from vx/vy (mi/s east/north, NaN if
+    unknown); agl (ft) and vrate (ft/min, NaN if unknown) give the height
+    above own-ship at CPA.  Returns four sequences: time to CPA (s, never
+    negative — a receding aircraft is at CPA now), miss distance (mi),
+    height above own-ship at CPA (ft) and time until the aircraft enters
+    ring_mi (s, NaN if it is inside already or will pass outside it).  A
+    row without a velocity gets NaN for all four.  ring_mi is one radius
+    for every row or a column of per-row radii.  Uses numpy when available
+    and a scalar loop otherwise.
+    """
+    if np is not None and len(dist):
+        d = np.frombuffer(dist, dtype=np.float64)
+        b = np.radians(np.frombuffer(bear, dtype=np.float64))
+        vx = np.frombuffer(vx, dtype=np.float64)
+        vy = np.frombuffer(vy, dtype=np.float64)
+        rx, ry = d * np.sin(b), d * np.cos(b)
+        v2 = vx * vx + vy * vy
+        with np.errstate(invalid="ignore", divide="ignore"):
+            t = np.where(v2 > 0, -(rx * vx + ry * vy) / v2, v2)  # v2 is 0 or NaN
+            t = np.maximum(t, 0.0)
+            miss = np.hypot(rx + vx * t, ry + vy * t)
+            h = np.frombuffer(agl, dtype=np.float64) + np.nan_to_num(
+                np.frombuffer(vrate, dtype=np.float64)) * t / 60
+            ring_mi = np.asarray(ring_mi, dtype=np.float64)
+            inside = np.sqrt(np.maximum(ring_mi * ring_mi - miss * miss, 0.0))
+            t_enter = np.where((d > ring_mi) & (miss < ring_mi),
+                               t - inside / np.sqrt(v2), np.nan)
+        return t, miss, h, t_enter
+
+    t_out, miss_out, h_out, enter_out = array("d"), array("d"), array("d"), array("d")
+    rings = ring_mi if hasattr(ring_mi, "__len__") else [ring_mi] * len(dist)
+    for d, b, ux, uy, a, vr, ring_mi in zip(dist, bear, vx, vy, agl, vrate, rings):
+        rad = math.radians(b)
+        rx, ry = d * math.sin(rad), d * math.cos(rad)
+        v2 = ux * ux + uy * uy
+        t = max(-(rx * ux + ry * uy) / v2, 0.0) if v2 > 0 else (0.0 if v2 == 0 else _NAN)
+        miss = math.hypot(rx + ux * t, ry + uy * t)
+        t_enter = _NAN
+        if d > ring_mi and miss < ring_mi:
+            t_enter = t - math.sqrt(ring_mi * ring_mi - miss * miss) / math.sqrt(v2)
+        t_out.append(t)
+        miss_out.append(miss)
+        h_out.append(a + (vr / 60 if vr == vr else 0.0) * t)
+        enter_out.append(t_enter)
+    return t_out, miss_out, h_out, enter_out
+
+
+# Constant-velocity Kalman filter, one independent [position, velocity] axis
+# at a time.  State and covariance are passed as plain floats so the per-
+# aircraft columns in TrackStore can be updated without allocating matrices.
+def _kf_predict(x, v, p00, p01, p11, dt, q):
+    x += v * dt
+    p00 += dt * (2 * p01 + dt * p11) + q * dt ** 3 / 3
+    p01 += dt * p11 + q * dt ** 2 / 2
+    p11 += q * dt
+    return x, v, p00, p01, p11
+
+
+def _kf_correct_pos(x, v, p00, p01, p11, z, r):
+    s = p00 + r
+    k0, k1 = p00 / s, p01 / s
+    e = z - x
+    return x + k0 * e, v + k1 * e, (1 - k0) * p00, (1 - k0) * p01, p11 - k1 * p01
+
+
+def _kf_correct_vel(x, v, p00, p01, p11, z, r):
+    s = p11 + r
+    k0, k1 = p01 / s, p11 / s
+    e = z - v
+    return x + k0 * e, v + k1 * e, p00 - k0 * p01, p01 - k0 * p11, p11 - k1 * p11
+
+
+def bearing_to_compass(bearing):
+    return COMPASS_POINTS[int((bearing + 11.25) / 22.5) % 16]
+
+
+def lookup_tail(reg_db, hexid):
+    if not reg_db:
+        return None
+    return reg_db.get(hexid.upper())
+
+
+def load_reg_db():
+    try:
+        with open(REG_DB_PATH) as f:
+            return json.load(f)
+    except Exception:
+        return {}
+
+
+# ── GPS helpers ────────────────────────────────────────────────────────────────
+def _gpsd_responding():
+    """Return True if gpsd is already listening on port 2947."""
+    try:
+        s = socket.create_connection(("127.0.0.1", 2947), timeout=1)
+        s.close()
+        return True
+    except OSError:
+        return False
+
+
+def fix_gps_setup():
+    """Ensure gpsd is running.
+
+    Only *starts* gpsd if it is not already responding — never restarts a
+    healthy daemon, which would interrupt an active fix.  Waits up to 15 s
+    for the port to become available after a start.
+    """
+    if _gpsd_responding():
+        return  # already up, nothing to do
+
+    try:
+        subprocess.run(
+            ["sudo", "/usr/bin/systemctl", "start", "gpsd"],
+            check=True, timeout=10,
+            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL,
+        )
+    except Exception:
+        pass  # best-effort; the wait loop below will tell us if it worked
+
+    for _ in range(15):
+        time.sleep(1)
+        if _gpsd_responding():
+            return
+
+
+@dataclass(frozen=True)
+class GpsFix:
+    """One own-ship fix, published whole so readers never see a half-update."""
+    lat: float
+    lon: float
+    mode: int
+    time: Optional[float]       # GPS epoch seconds of the fix, if reported
+    speed: Optional[float]      # m/s over ground
+    track: Optional[float]      # deg true
+    eph: Optional[float]        # m, estimated horizontal error
+    received: float             # time.time() when it was parsed
+
+    def at(self, t):
+        """(lat, lon, vx, vy) of own-ship dead-reckoned to local time t.
+
+        t is on the time.time() clock and the span is measured from
+        `received`, never from the receiver's `time`, so GPS time and the
+        host clock are never differenced.  vx/vy are east/north mi/s from
+        TPV speed and track; below GPS_MIN_SPEED_MPS the receiver is taken
+        as parked, since a standing fix wanders with a random track.  The
+        span is capped at GPS_STALE_SEC.
+        """
+        speed, track = self.speed, self.track
+        if speed is None or track is None or speed < GPS_MIN_SPEED_MPS:
+            return self.lat, self.lon, 0.0, 0.0
+        v = speed * MPH_PER_MPS / 3600
+        vx = v * math.sin(math.radians(track))
+        vy = v * math.cos(math.radians(track))
+        dt = t - self.received
+        dt = max(-GPS_STALE_SEC, min(dt, GPS_STALE_SEC))
+        lat = self.lat + vy * dt / MI_PER_DEG
+        lon = self.lon + vx * dt / (math.cos(math.radians(self.lat)) * MI_PER_DEG)
+        return lat, lon, vx, vy
+
+
+def _iso_time(text):
+    try:
+        return datetime.fromisoformat(text.replace("Z", "+00:00")).timestamp()
+    except (AttributeError, ValueError):
+        return None
+
+
+def parse_tpv(line, received):
+    """GpsFix for a gpsd TPV line, False for a TPV without a fix, else None."""
+    try:
+        msg = _json_loads(line)
+    except ValueError:
+        return None
+    if not isinstance(msg, dict) or msg.get("class") != "TPV":
+        return None
+    lat, lon, mode = msg.get("lat"), msg.get("lon"), msg.get("mode", 0)
+    if mode < 2 or lat is None or lon is None:
+        return False
+    return GpsFix(lat, lon, mode, _iso_time(msg.get("time")), msg.get("speed"),
+                  msg.get("track"), msg.get("eph"), received)
+
+
+class _FixSource:
+    """Shared plumbing for the own-ship readers: publish, staleness, pumping.
+
+    Fixes go to on_fix as GpsFix objects the moment they are parsed;
+    on_fix(None) reports a lost fix, a silent receiver (GPS_STALE_SEC
+    without a fix) or a lost link, once per loss.
+    """
+
+    def __init__(self, on_fix):
+        self.on_fix = on_fix
+        self.running = False
+        self._buf = bytearray()
+        self._pos = 0                   # start of the unparsed tail of _buf
+        self._have_fix = False
+        self._fix_t = 0.0
+
+    def _publish(self, fix):
+        if fix:
+            self._have_fix = True
+            self._fix_t = fix.received
+            self.on_fix(fix)
+        elif self._have_fix:
+            self._have_fix = False
+            self.on_fix(None)
+
+    def _compact(self):
+        if self._pos > 4096 and self._pos * 2 > len(self._buf):
+            del self._buf[:self._pos]   # drop the consumed head now and then
+            self._pos = 0
+
+    def _lost(self):
+        self._buf.clear()
+        self._pos = 0
+        self._publish(None)
+
+    def _pump(self, fileobj, read):
+        """Feed everything read() returns until it reports end of stream."""
+        with selectors.DefaultSelector() as sel:
+            sel.register(fileobj, selectors.EVENT_READ)
+            while self.running:
+                if sel.select(1.0):
+                    try:
+                        data = read(65536)
+                    except BlockingIOError:
+                        continue
+                    if not data:
+                        return
+                    self.feed(data)
+                if self._have_fix and time.time() - self._fix_t > GPS_STALE_SEC:
+                    self._publish(None)
+
+    def stop(self):
+        self.running = False
+
+
+class GpsdClient(_FixSource):
+    """Event-driven gpsd reader on one non-blocking socket.
+
+    run() waits on the socket with epoll, appends whatever arrived to a
+    buffer that persists across reads, and parses each complete line the
+    moment it lands — a TPV split across packets is finished by the next
+    read instead of being dropped.
+    """
+
+    def __init__(self, on_fix, host="127.0.0.1", port=2947):
+        super().__init__(on_fix)
+        self.host = host
+        self.port = port
+
+    def feed(self, data, now=None):
+        """Parse newly received bytes; any trailing partial line is kept."""
+        now = time.time() if now is None else now
+        buf = self._buf
+        buf += data
+        while True:
+            end = buf.find(b"\n", self._pos)
+            if end < 0:
+                break
+            line = bytes(buf[self._pos:end])
+            self._pos = end + 1
+            fix = parse_tpv(line, now) if b'"TPV"' in line else None
+            if fix is not None:
+                self._publish(fix)
+        self._compact()
+
+    def run(self):
+        self.running = True
+        delay = 1.0
+        while self.running:
+            try:
+                sock = socket.create_connection((self.host, self.port), timeout=5)
+            except OSError:
+                self._lost()
+                time.sleep(delay)
+                delay = min(delay * 2, 30.0)  # exponential backoff, cap at 30 s
+                continue
+            delay = 1.0                       # reset backoff on successful connect
+            try:
+                sock.sendall(b'?WATCH={"enable":true,"json":true}\n')
+                sock.setblocking(False)
+                self._pump(sock, sock.recv)   # returns when gpsd goes away
+            except OSError:
+                pass
+            finally:
+                sock.close()
+                self._lost()
+
+
+def _nmea_coord(value, hemi):
+    """ddmm.mmmm / dddmm.mmmm plus N/S/E/W to signed degrees, or None."""
+    if not value:
+        return None
+    dot = value.find(b".")
+    head = dot - 2 if dot >= 0 else len(value) - 2
+    deg = int(value[:head]) + float(value[head:]) / 60
+    return -deg if hemi in (b"S", b"W") else deg
+
+
+def _ubx_frame(cls, msg_id, payload=b""):
+    body = struct.pack("<BBH", cls, msg_id, len(payload)) + payload
+    a = b = 0
+    for c in body:
+        a = (a + c) & 0xFF
+        b = (b + a) & 0xFF
+    return b"\xb5\x62" + body + bytes((a, b))
+
+
+_UBX_NAV_PVT = struct.Struct("<IHBBBBBBIiBBBBiiiiIIiiiiiII")
+
+
+class NmeaReader(_FixSource):
+    """Own-ship fixes straight from the receiver's serial port, no gpsd.
+
+    The port is put in raw mode at `baud` and read non-blocking under
+    epoll.  feed() is a small state machine over one persistent buffer:
+    hunt for a sync byte, then take a whole NMEA sentence ($ … \\n, checksum
+    checked) or, with ubx=True, a whole UBX frame (B5 62 …, Fletcher
+    checked, decoded in place with struct.unpack_from).  Anything that
+    fails is skipped to the next sync byte.
+
+    RMC carries everything a fix needs — time, position, speed, course —
+    so each valid RMC is published on arrival; GGA contributes fix quality
+    and HDOP, VTG a course/speed when RMC leaves them blank.  A NAV-PVT
+    frame is a complete fix on its own.
+    """
+
+    UERE_M = 5.0                        # m per unit HDOP, for eph
+    MAX_SENTENCE = 100                  # NMEA caps a sentence at 82 bytes
+    MAX_UBX = 1024
+
+    def __init__(self, on_fix, device=GPS_DEVICE, baud=GPS_BAUD, ubx=False):
+        super().__init__(on_fix)
+        self.device = device
+        self.baud = baud
+        self.ubx = ubx
+        self.quality = None             # GGA fix quality, None before any GGA
+        self.hdop = None
+        self.vtg = (None, None)         # last VTG (track, speed m/s)
+
+    # ── Parsing ────────────────────────────────────────────────────────────────
+    def feed(self, data, now=None):
+        now = time.time() if now is None else now
+        buf = self._buf
+        buf += data
+        pos, n = self._pos, len(buf)
+        while pos < n:
+            c = buf[pos]
+            if c == 0x24:                                   # '$' — NMEA
+                end = buf.find(b"\n", pos)
+                resync = buf.find(b"$", pos + 1, end if end >= 0 else n)
+                if resync >= 0 or (end >= 0 and end - pos > self.MAX_SENTENCE):
+                    pos = resync if resync >= 0 else end + 1  # truncated sentence
+                    continue
+                if end < 0:
+                    if n - pos > self.MAX_SENTENCE:
+                        pos += 1
+                        continue
+                    break                                   # wait for the rest
+                self._sentence(bytes(buf[pos + 1:end]).rstrip(b"\r"), now)
+                pos = end + 1
+            elif c == 0xB5 and self.ubx:                    # UBX sync 1
+                if n - pos < 6:
+                    break
+                length = buf[pos + 4] | buf[pos + 5] << 8
+                if buf[pos + 1] != 0x62 or length > self.MAX_UBX:
+                    pos += 1
+                    continue
+                if n - pos < length + 8:
+                    break
+                if self._ubx_ok(buf, pos, length):
+                    self._ubx_frame(buf, pos, length, now)
+                    pos += length + 8
+                else:
+                    pos += 1
+            else:                                           # hunt for sync
+                nxt = buf.find(b"$", pos + 1)
+                if self.ubx:
+                    u = buf.find(b"\xb5", pos + 1)
+                    if u >= 0 and (nxt < 0 or u < nxt):
+                        nxt = u
+                pos = nxt if nxt >= 0 else n
+        self._pos = pos
+        self._compact()
+
+    def _sentence(self, s, now):
+        star = len(s) - 3
+        if star < 6 or s[star] != 0x2A:                     # '*'
+            return
+        x = 0
+        for c in s[:star]:
+            x ^= c
+        try:
+            if x != int(s[star + 1:], 16):
+                return
+        except ValueError:
+            return
+        f = s[:star].split(b",")
+        kind = f[0][2:]                                     # drop the talker id
+        try:
+            if kind == b"RMC" and len(f) >= 10:
+                self._rmc(f, now)
+            elif kind == b"GGA" and len(f) >= 10:
+                self.quality = int(f[6]) if f[6] else 0
+                self.hdop = float(f[8]) if f[8] else None
+            elif kind == b"VTG" and len(f) >= 8:
+                self.vtg = (float(f[1]) if f[1] else None,
+                            float(f[7]) / 3.6 if f[7] else None)
+        except ValueError:
+            pass                                            # malformed field
+
+    def _rmc(self, f, now):
+        if f[2] != b"A" or self.quality == 0:
+            self._publish(None)
+            return
+        lat, lon = _nmea_coord(f[3], f[4]), _nmea_coord(f[5], f[6])
+        if lat is None or lon is None:
+            return
+        t = None
+        hms, dmy = f[1], f[9]
+        if len(hms) >= 6 and len(dmy) == 6:
+            t = calendar.timegm((2000 + int(dmy[4:6]), int(dmy[2:4]), int(dmy[0:2]),
+                                 int(hms[0:2]), int(hms[2:4]), 0)) + float(hms[4:])
+        track = float(f[8]) if f[8] else self.vtg[0]
+        speed = float(f[7]) * 0.514444 if f[7] else self.vtg[1]    # kn -> m/s
+        eph = self.hdop * self.UERE_M if self.hdop is not None else None
+        self._publish(GpsFix(lat, lon, 3 if self.quality else 2, t, speed, track, eph, now))
+
+    @staticmethod
+    def _ubx_ok(buf, pos, length):
+        a = b = 0
+        for i in range(pos + 2, pos + 6 + length):
+            a = (a + buf[i]) & 0xFF
+            b = (b + a) & 0xFF
+        return buf[pos + 6 + length] == a and buf[pos + 7 + length] == b
+
+    def _ubx_frame(self, buf, pos, length, now):
+        if buf[pos + 2] != 0x01 or buf[pos + 3] != 0x07 or length < _UBX_NAV_PVT.size:
+            return                                          # only NAV-PVT is used
+        (_, year, month, day, hour, minute, sec, valid, _, nano, fix_type, flags,
+         _, _, lon, lat, _, _, h_acc, _, vel_n, vel_e, _, g_speed, head_mot,
+         _, _) = _UBX_NAV_PVT.unpack_from(buf, pos + 6)
+        if not flags & 1 or fix_type not in (2, 3, 4):
+            self._publish(None)
+            return
+        t = None
+        if valid & 3 == 3:                                  # date and time valid
+            t = calendar.timegm((year, month, day, hour, minute, sec)) + nano * 1e-9
+        self._publish(GpsFix(lat * 1e-7, lon * 1e-7, 2 if fix_type == 2 else 3, t,
+                             g_speed / 1000, head_mot * 1e-5, h_acc / 1000, now))
+
+    # ── Port ───────────────────────────────────────────────────────────────────
+    def _open(self):
+        fd = os.open(self.device, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+        try:
+            speed = getattr(termios, f"B{self.baud}")
+            attrs = termios.tcgetattr(fd)
+            attrs[0] = termios.IGNPAR                       # iflag
+            attrs[1] = 0                                    # oflag
+            attrs[2] = termios.CS8 | termios.CLOCAL | termios.CREAD
+            attrs[3] = 0                                    # lflag: raw
+            attrs[4] = attrs[5] = speed
+            termios.tcsetattr(fd, termios.TCSANOW, attrs)
+            if self.ubx:
+                # CFG-MSG: NAV-PVT once per solution on the port we are on.
+                os.write(fd, _ubx_frame(0x06, 0x01, bytes((0x01, 0x07, 1))))
+        except (OSError, AttributeError, termios.error):
+            os.close(fd)
+            raise
+        return fd
+
+    def run(self):
+        self.running = True
+        delay = 1.0
+        while self.running:
+            try:
+                fd = self._open()
+            except (OSError, AttributeError, termios.error):
+                self._lost()
+                time.sleep(delay)
+                delay = min(delay * 2, 30.0)
+                continue
+            delay = 1.0
+            try:
+                self._pump(fd, lambda size: os.read(fd, size))
+            except OSError:
+                pass                                        # device unplugged
+            finally:
+                os.close(fd)
+                self._lost()
+
+
+# ── Ingest ─────────────────────────────────────────────────────────────────────
+_NAN = float("nan")
+
+
+class AircraftSnapshot:
+    """One aircraft.json write, packed as parallel columns.
+
+    Only the fields the update loop consumes are kept, and rows without a
+    position or a numeric altitude are dropped at parse time so every row is
+    usable.  Missing track / ground speed are stored as NaN so the numeric
+    columns stay homogeneous.
+    """
+    __slots__ = ("now", "total", "hexid", "lat", "lon", "alt",
+                 "track", "gs", "flight", "seen_pos", "vrate", "_grid")
+
+    def __init__(self, now=None, total=0):
+        self.now    = now           # readsb timestamp of the write
+        self.total  = total         # every entry in the file, usable or not
+        self.hexid  = []
+        self.lat    = array("d")
+        self.lon    = array("d")
+        self.alt    = array("d")    # alt_baro, falling back to alt_geom
+        self.track  = array("d")
+        self.gs     = array("d")
+        self.flight = []
+        self.seen_pos = array("d")  # age of the position at `now`, in seconds
+        self.vrate  = array("d")    # ft/min, baro_rate falling back to geom_rate
+        self._grid  = None
+
+    def __len__(self):
+        return len(self.hexid)
+
+    def grid(self):
+        """GridIndex over the lon/lat columns, built on first use."""
+        if self._grid is None:
+            self._grid = GridIndex(self.lon, self.lat, GRID_CELL_DEG)
+        return self._grid
+
+    @classmethod
+    def from_rows(cls, now, total, rows):
+        """Build a snapshot from (hex, lat, lon, alt, track, gs, flight,
+        seen_pos, vrate) tuples."""
+        snap = cls(now, total)
+        if rows:
+            # Transpose once and bulk-load the numeric columns, which is much
+            # cheaper than growing nine arrays an element at a time.
+            hexid, lat, lon, alt, track, gs, flight, seen_pos, vrate = zip(*rows)
+            snap.hexid  = list(hexid)
+            snap.lat    = array("d", lat)
+            snap.lon    = array("d", lon)
+            snap.alt    = array("d", alt)
+            snap.track  = array("d", [_NAN if t is None else t for t in track])
+            snap.gs     = array("d", [_NAN if g is None else g for g in gs])
+            snap.flight = [f.strip() for f in flight]
+            snap.seen_pos = array("d", [0.0 if a is None else a for a in seen_pos])
+            snap.vrate  = array("d", [_NAN if r is None else r for r in vrate])
+        return snap
+
+
+def parse_aircraft_json(raw):
+    """Parse readsb aircraft.json bytes into an AircraftSnapshot."""
+    data = _json_loads(raw)
+    entries = data.get("aircraft", [])
+    rows = []
+    for ac in entries:
+        hx  = ac.get("hex")
+        lat = ac.get("lat")
+        lon = ac.get("lon")
+        if not hx or lat is None or lon is None:
+            continue
+        alt = ac.get("alt_baro", ac.get("alt_geom"))  # baro is MSL like FIELD_ELEV_FT
+        if alt is None or isinstance(alt, str):
+            continue
+        rows.append((hx, lat, lon, alt, ac.get("track", _NAN), ac.get("gs", _NAN),
+                     ac.get("flight") or "", ac.get("seen_pos"),
+                     ac.get("baro_rate", ac.get("geom_rate"))))
+    return AircraftSnapshot.from_rows(data.get("now"), len(entries), rows)
+
+
+def read_aircraft_json(path=None):
+    with open(path or AIRCRAFT_JSON, "rb") as f:
+        return parse_aircraft_json(f.read())
+
+
+class ClockOffset:
+    """Local clock minus readsb's, measured from the snapshots themselves.
+
+    Each snapshot pairs readsb's `now` with our time.time() on reading it,
+    which over-reads the offset by however late the write was picked up.
+    The smallest sample of the last CLOCK_OFFSET_WINDOW_SEC is kept, so a
+    slow read does not shift it and a stepped clock is followed within
+    the window.
+    """
+
+    def __init__(self):
+        self._win = deque()             # (local, offset), offsets increasing
+        self.offset = 0.0
+
+    def update(self, remote, local):
+        """Add one (readsb time, local time) pair and return the offset.
+
+        A snapshot without readsb's time is already on our clock: 0.
+        """
+        if remote is None:
+            return 0.0
+        off = local - remote
+        win = self._win
+        while win and win[-1][1] >= off:
+            win.pop()
+        win.append((local, off))
+        while local - win[0][0] > CLOCK_OFFSET_WINDOW_SEC:
+            win.popleft()
+        self.offset = win[0][1]
+        return self.offset
+
+
+_IN_CLOSE_WRITE = 0x00000008
+_IN_MOVED_TO    = 0x00000080
+_IN_MOVE_SELF   = 0x00000800
+_IN_Q_OVERFLOW  = 0x00004000
+_IN_IGNORED     = 0x00008000   # watch gone: directory deleted or unmounted
+_IN_EVENT       = struct.Struct("iIII")   # wd, mask, cookie, len — then the name
+
+
+class AircraftJsonWatcher:
+    """Reads each readsb write of aircraft.json exactly once.
+
+    On Linux the directory is watched with inotify (IN_CLOSE_WRITE for
+    in-place writes, IN_MOVED_TO for readsb's write-then-rename), and the
+    descriptor from fileno() can be handed to the event loop so a fresh
+    snapshot is processed the moment it lands.  Without inotify, poll() is
+    simply called on a timer.  If the directory is deleted or moved (readsb
+    restarting recreates /run/readsb) the watch is dropped, `watching` goes
+    false so callers fall back to the timer, and every drain or poll tries to
+    re-arm it on the path.  Either way the file is mapped rather than
+    read, and a write is skipped if its inode/mtime/size — or readsb's own
+    "now" stamp — matches the snapshot already delivered.
+
+    Counters: snapshots_seen, duplicates_skipped, read_ms (map + parse time)
+    and age_ms (file mtime to parsed snapshot) for the last delivery.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self.snapshots_seen = 0
+        self.duplicates_skipped = 0
+        self.read_ms = None
+        self.age_ms = None
+        self._key = None
+        self._now = None
+        self._fd = None
+        self._wd = -1
+        try:
+            self._libc = ctypes.CDLL(None, use_errno=True)
+            fd = self._libc.inotify_init1(os.O_NONBLOCK | os.O_CLOEXEC)
+            if fd >= 0:
+                self._fd = fd
+                self._add_watch()
+        except (OSError, AttributeError):
+            self._fd = None  # no inotify on this platform — timer polling only
+
+    def fileno(self):
+        return self._fd
+
+    @property
+    def watching(self):
+        return self._wd >= 0
+
+    def _add_watch(self):
+        directory = os.path.dirname(self.path) or "."
+        self._wd = self._libc.inotify_add_watch(
+            self._fd, os.fsencode(directory),
+            _IN_CLOSE_WRITE | _IN_MOVED_TO | _IN_MOVE_SELF)
+
+    def drain_events(self):
+        """Consume pending inotify events; True if any touched our file.
+
+        Losing the watch also counts as a hit: the file may have been
+        rewritten before the watch could be re-armed, so it is worth a read.
+        """
+        if self._fd is None:
+            return False
+        name = os.fsencode(os.path.basename(self.path))
+        hit = False
+        while True:
+            try:
+                buf = os.read(self._fd, 4096)
+            except BlockingIOError:
+                break
+            off = 0
+            while off < len(buf):
+                wd, mask, _, length = _IN_EVENT.unpack_from(buf, off)
+                off += _IN_EVENT.size
+                if mask & _IN_Q_OVERFLOW:
+                    hit = True      # events were dropped; one of them may be ours
+                elif wd == self._wd and mask & (_IN_IGNORED | _IN_MOVE_SELF):
+                    # A moved directory keeps its watch, so drop it by hand;
+                    # the IN_IGNORED that follows carries a stale wd.
+                    if mask & _IN_MOVE_SELF:
+                        self._libc.inotify_rm_watch(self._fd, wd)
+                    self._wd = -1
+                    hit = True
+                elif buf[off:off + length].rstrip(b"\0") == name:
+                    hit = True
+                off += length
+        if not self.watching:
+            self._add_watch()
+        return hit
+
+    def poll(self):
+        """Return a new AircraftSnapshot, or None if nothing new was written.
+
+        Raises OSError if the file is missing so callers can report the feed
+        as down.  The watch is retried here so starting before readsb has
+        created its run directory still ends up event driven.
+        """
+        if self._fd is not None and not self.watching:
+            self._add_watch()
+        t0 = time.time()
+        with open(self.path, "rb") as f:
+            st = os.fstat(f.fileno())
+            key = (st.st_ino, st.st_mtime_ns, st.st_size)
+            if key == self._key:
+                self.duplicates_skipped += 1
+                return None
+            if st.st_size == 0:
+                raise OSError("aircraft.json is empty")
+            with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+                if _json_loads is json.loads:
+                    snap = parse_aircraft_json(mm[:])   # stdlib json needs bytes
+                else:
+                    with memoryview(mm) as view:    # orjson parses the mapping in place
+                        snap = parse_aircraft_json(view)
+        self._key = key
+        if snap.now is not None and snap.now == self._now:
+            self.duplicates_skipped += 1
+            return None
+        self._now = snap.now
+        done = time.time()
+        self.snapshots_seen += 1
+        self.read_ms = (done - t0) * 1000
+        self.age_ms = (done - st.st_mtime_ns / 1e9) * 1000
+        return snap
+
+
+class _SbsTrack:
+    __slots__ = ("lat", "lon", "alt", "track", "gs", "vrate", "flight", "seen_pos", "seen")
+
+    def __init__(self):
+        self.lat = self.lon = self.alt = self.track = self.gs = self.vrate = None
+        self.flight = ""
+        self.seen_pos = self.seen = 0.0
+
+
+class SbsFeed:
+    """Push ingest from readsb's SBS/BaseStation text output (port 30003).
+
+    A reader thread folds each MSG line into a per-hex state table the moment
+    it arrives and calls on_position() whenever a line carried a new position,
+    so the update loop can run without waiting for the next aircraft.json
+    rewrite.  snapshot() packs the table into the same AircraftSnapshot the
+    JSON path produces, so everything downstream is shared.
+    """
+
+    def __init__(self, host=SBS_HOST, port=SBS_PORT, on_position=None):
+        self.host = host
+        self.port = port
+        self.connected = False
+        self._on_position = on_position
+        self._tracks = {}
+        self._lock = threading.Lock()
+        self._running = False
+
+    def start(self):
+        self._running = True
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def stop(self):
+        self._running = False
+
+    def _run(self):
+        delay = 1.0
+        while self._running:
+            try:
+                with socket.create_connection((self.host, self.port), timeout=5) as sock:
+                    sock.settimeout(5.0)
+                    self.connected = True
+                    delay = 1.0  # reset backoff on successful connect
+                    buf = b""
+                    while self._running:
+                        try:
+                            chunk = sock.recv(65536)
+                        except socket.timeout:
+                            continue  # quiet sky — keep the connection
+                        if not chunk:
+                            raise ConnectionError("SBS feed closed")
+                        buf += chunk
+                        *lines, buf = buf.split(b"\n")
+                        if self.feed_lines(lines, time.time()) and self._on_position:
+                            self._on_position()
+            except OSError:
+                pass
+            self.connected = False
+            if self._running:
+                time.sleep(delay)
+                delay = min(delay * 2, 30.0)  # exponential backoff, cap at 30 s
+
+    def feed_lines(self, lines, now):
+        """Apply raw SBS lines to the state table; True if any moved an aircraft."""
+        moved = False
+        with self._lock:
+            for line in lines:
+                f = line.decode("ascii", "ignore").strip().split(",")
+                if len(f) < 17 or f[0] != "MSG":
+                    continue
+                hexid = f[4].strip().lower()
+                if not hexid:
+                    continue
+                t = self._tracks.get(hexid)
+                if t is None:
+                    t = self._tracks[hexid] = _SbsTrack()
+                t.seen = now
+                try:
+                    if f[10].strip():
+                        t.flight = f[10].strip()
+                    if f[11]:
+                        t.alt = float(f[11])
+                    if len(f) > 21 and f[21] == "-1":
+                        t.alt = None  # on the ground — JSON reports "ground"
+                    if f[12]:
+                        t.gs = float(f[12])
+                    if f[13]:
+                        t.track = float(f[13])
+                    if f[16]:
+                        t.vrate = float(f[16])
+                    if f[14] and f[15]:
+                        t.lat = float(f[14])
+                        t.lon = float(f[15])
+                        t.seen_pos = now
+                        moved = True
+                except ValueError:
+                    continue  # malformed field — keep what we already had
+        return moved
+
+    def snapshot(self, now=None):
+        """Pack every track with a recent position into an AircraftSnapshot."""
+        now = time.time() if now is None else now
+        rows = []
+        with self._lock:
+            for hexid in [h for h, t in self._tracks.items()
+                          if now - t.seen > SBS_TRACK_EXPIRE_SEC]:
+                del self._tracks[hexid]
+            for hexid, t in self._tracks.items():
+                if (t.lat is None or t.alt is None
+                        or now - t.seen_pos > SBS_POSITION_MAX_AGE):
+                    continue
+                rows.append((hexid, t.lat, t.lon, t.alt, t.track, t.gs, t.flight,
+                             now - t.seen_pos, t.vrate))
+            total = len(self._tracks)
+        return AircraftSnapshot.from_rows(now, total, rows)
+
+
+class _Waker:
+    """Self-pipe that lets a background thread wake the Tk event loop."""
+
+    def __init__(self):
+        self._r, self._w = os.pipe()
+        os.set_blocking(self._r, False)
+        os.set_blocking(self._w, False)
+
+    def fileno(self):
+        return self._r
+
+    def wake(self):
+        try:
+            os.write(self._w, b"\0")
+        except BlockingIOError:
+            pass  # pipe already full — a wake-up is pending anyway
+
+    def drain(self):
+        try:
+            while os.read(self._r, 4096):
+                pass
+        except BlockingIOError:
+            pass
+
+
+# ── Data model ─────────────────────────────────────────────────────────────────
+class AircraftTable:
+    """Hex-indexed struct-of-arrays table of in-range aircraft.
+
+    The engine keeps one table for the life of the process and overwrites
+    rows in place each cycle.  A hex keeps the same slot for as long as it
+    stays in range, so selection, distance ordering and the radar can all
+    refer to aircraft by slot number.  Freed slots are reused before the
+    columns grow.  Missing optional values are stored as NaN.  rx/ry/vx/vy/
+    pos_t are the motion columns predict_positions() dead-reckons from.
+    """
+    _FLOAT_COLS = ("lat", "lon", "alt", "dist", "track", "gs", "closing",
+                   "closing_sd", "eta", "cpa_t", "cpa_mi", "cpa_agl", "bearing", "agl",
+                   "rx", "ry", "vx", "vy", "pos_t")
+    _BYTE_COLS  = ("level", "orbiting")
+    _OBJ_COLS   = ("hexid", "flight", "tail")
+
+    def __init__(self):
+        self.slot_of = {}
+        self._free = []
+        for name in self._FLOAT_COLS:
+            setattr(self, name, array("d"))
+        for name in self._BYTE_COLS:
+            setattr(self, name, array("b"))
+        for name in self._OBJ_COLS:
+            setattr(self, name, [])
+
+    def __len__(self):
+        return len(self.slot_of)
+
+    def upsert(self, hexid):
+        """Return the slot for hexid, claiming a free one on first sight."""
+        slot = self.slot_of.get(hexid)
+        if slot is not None:
+            return slot
+        if self._free:
+            slot = self._free.pop()
+        else:
+            slot = len(self.hexid)
+            for name in self._FLOAT_COLS:
+                getattr(self, name).append(_NAN)
+            for name in self._BYTE_COLS:
+                getattr(self, name).append(0)
+            for name in self._OBJ_COLS:
+                getattr(self, name).append(None)
+        self.hexid[slot] = hexid
+        self.slot_of[hexid] = slot
+        return slot
+
+    def release(self, hexid):
+        slot = self.slot_of.pop(hexid, None)
+        if slot is not None:
+            self.hexid[slot] = None
+            self._free.append(slot)
+
+    def freeze(self):
+        """Copy of the table for publishing; costs one allocation per column."""
+        t = AircraftTable.__new__(AircraftTable)
+        t.slot_of = self.slot_of.copy()
+        t._free = []
+        for name in self._FLOAT_COLS + self._BYTE_COLS + self._OBJ_COLS:
+            setattr(t, name, getattr(self, name)[:])
+        return t
+
+
+def _optional(col):
+    """Property over a float column where NaN stands for a missing value."""
+    def get(self):
+        v = getattr(self._t, col)[self.slot]
+        return None if v != v else v
+    return property(get)
+
+
+class Aircraft:
+    """Read-only view of one AircraftTable row.
+
+    Views hold only the table and slot, so they are cheap to make for the
+    handful of aircraft that get a card, the banner or an alert.
+    """
+    __slots__ = ("_t", "slot")
+
+    def __init__(self, table, slot):
+        self._t = table
+        self.slot = slot
+
+    hexid           = property(lambda self: self._t.hexid[self.slot])
+    lat             = property(lambda self: self._t.lat[self.slot])
+    lon             = property(lambda self: self._t.lon[self.slot])
+    alt_ft          = property(lambda self: int(self._t.alt[self.slot]))
+    dist_mi         = property(lambda self: self._t.dist[self.slot])
+    flight          = property(lambda self: self._t.flight[self.slot])
+    tail            = property(lambda self: self._t.tail[self.slot])
+    threat_level    = property(lambda self: self._t.level[self.slot])
+    bearing_from_me = property(lambda self: self._t.bearing[self.slot])
+    alt_agl         = property(lambda self: int(self._t.agl[self.slot]))
+    is_orbiting     = property(lambda self: bool(self._t.orbiting[self.slot]))
+    track           = _optional("track")
+    speed_kts       = _optional("gs")
+    closing_mph     = _optional("closing")
+    closing_sd      = _optional("closing_sd")
+    eta_1mi_sec     = _optional("eta")
+    cpa_sec         = _optional("cpa_t")
+    cpa_miss_mi     = _optional("cpa_mi")
+    cpa_agl         = _optional("cpa_agl")
+
+    @property
+    def ident(self):
+        if self.tail:
+            return self.tail + (f" {self.flight}" if self.flight else "")
+        return self.flight or self.hexid.upper()
+
+    @property
+    def eta_str(self):
+        if self.eta_1mi_sec is None:
+            return "ETA ---"
+        if self.eta_1mi_sec < 60:
+            return f"ETA {int(self.eta_1mi_sec)}s"
+        return f"ETA {self.eta_1mi_sec / 60:.1f}m"
+
+    @property
+    def closing_str(self):
+        if self.closing_mph is None or self.closing_mph <= 0:
+            return ""
+        return f"{self.closing_mph:.0f}mph"
+
+    @property
+    def cpa_str(self):
+        if self.cpa_miss_mi is None:
+            return ""
+        return (f"CPA {self.cpa_miss_mi:.2f}mi  {self.cpa_sec:.0f}s  "
+                f"{self.cpa_agl:.0f}ft")
+
+
+# ── Per-aircraft state ─────────────────────────────────────────────────────────
+def icao_key(hexid):
+    """24-bit ICAO address as an int; readsb's non-ICAO '~' addresses get bit 24."""
+    if hexid[0] == "~":
+        return int(hexid[1:], 16) | 0x1000000
+    return int(hexid, 16)
+
+
+class OrbitTracker:
+    """Detects circling aircraft from a sliding window of headings.
+
+    Each TrackStore record owns a fixed-capacity ring of (time, heading)
+    samples in two preallocated arrays, plus a running sum of the signed
+    turn between consecutive samples.  Deltas are added as samples arrive
+    and subtracted as they age out of ORBIT_TIME_WINDOW, so an update is
+    O(1) however many samples the window holds.  Deltas are summed as whole
+    microdegrees, which a double holds exactly, so adding and removing the
+    same delta cancels and the sum cannot drift off the threshold the way a
+    running float sum does.  Samples closer together
+    than ORBIT_MIN_SAMPLE_SEC are skipped so push ingest cannot overrun the
+    ring; if it fills anyway the oldest sample is dropped early.
+    """
+    RING = 256          # samples per record — the window at 2 Hz
+    UNIT = 1e6          # turn sums are kept in microdegrees
+
+    @staticmethod
+    def _delta(h0, h1):
+        """Signed turn from heading h0 to h1, in whole microdegrees."""
+        return round(((h1 - h0 + 180) % 360 - 180) * OrbitTracker.UNIT)
+
+    def __init__(self, capacity):
+        zeros = bytes(8 * self.RING * capacity)
+        self._t = array("d", zeros)
+        self._h = array("d", zeros)
+        self._head  = array("l", [0]) * capacity
+        self._count = array("l", [0]) * capacity
+        self._turn  = array("d", bytes(8 * capacity))
+        self._last  = array("b", bytes(capacity))   # previous decision, for skipped samples
+
+    def reset(self, rec):
+        self._count[rec] = 0
+        self._turn[rec] = 0.0
+        self._last[rec] = 0
+
+    def update(self, rec, track, now):
+        if track is None:
+            return False
+        cap = self.RING
+        base = rec * cap
+        head, count, total_turn = self._head[rec], self._count[rec], self._turn[rec]
+        t, h = self._t, self._h
+        track = float(track)
+
+        if count and now - t[base + (head + count - 1) % cap] < ORBIT_MIN_SAMPLE_SEC:
+            return bool(self._last[rec])
+        delta = self._delta
+        if count == cap:      # ring full — drop the oldest sample early
+            total_turn -= delta(h[base + head], h[base + (head + 1) % cap])
+            head = (head + 1) % cap
+            count -= 1
+        if count:
+            total_turn += delta(h[base + (head + count - 1) % cap], track)
+        t[base + (head + count) % cap] = now
+        h[base + (head + count) % cap] = track
+        count += 1
+
+        cutoff = now - ORBIT_TIME_WINDOW
+        while t[base + head] < cutoff:
+            total_turn -= delta(h[base + head], h[base + (head + 1) % cap])
+            head = (head + 1) % cap
+            count -= 1
+        self._head[rec], self._count[rec], self._turn[rec] = head, count, total_turn
+
+        orbiting = False
+        time_span = t[base + (head + count - 1) % cap] - t[base + head]
+        turn = abs(total_turn) / self.UNIT
+        # Require a sustained turn rate so normal gradual course changes
+        # don't accumulate enough degrees to look like an orbit.
+        if (count >= 6 and time_span >= 10
+                and turn >= ORBIT_HEADING_THRESHOLD
+                and turn / time_span >= ORBIT_MIN_TURN_RATE_DPS):
+            orbiting = True
+        self._last[rec] = orbiting
+        return orbiting
+
+
+class TrackStore:
+    """Everything remembered about an aircraft between cycles, in one record.
+
+    Records live in fixed columns sized to TRACK_STORE_MAX and are keyed by
+    icao_key().  The index is kept in least-recently-seen order: records not
+    seen for TRACK_STATE_TTL_SEC are dropped by expire(), and if the pool is
+    full the stalest record is recycled, so memory stays constant however
+    long the session runs.
+
+    Each record also carries a constant-velocity Kalman filter of the
+    aircraft's ground track, in a flat east/north frame (miles, seconds)
+    anchored at its first reported position.  Positions and, when readsb has
+    them, gs/track velocities are fused in O(1) per report; range_rate()
+    projects the filtered velocity onto the line of sight to own-ship.
+    NaN in kf_t marks a filter that has not been started.
+    """
+
+    def __init__(self, capacity=TRACK_STORE_MAX):
+        self.capacity = capacity
+        self._index = OrderedDict()     # key -> record, least recently seen first
+        self._free = list(range(capacity - 1, -1, -1))
+        self.seen       = array("d", bytes(8 * capacity))
+        self.warn_t     = array("d", bytes(8 * capacity))
+        self.orbit_warn_t = array("d", bytes(8 * capacity))
+        self.orbit = OrbitTracker(capacity)
+        self.kf_t = array("d", [_NAN]) * capacity          # time of the last fused report
+        for name in ("org_lat", "org_lon", "org_cos",
+                     "kx", "kvx", "kpx", "kpxv", "kpvx",
+                     "ky", "kvy", "kpy", "kpyv", "kpvy"):
+            setattr(self, name, array("d", bytes(8 * capacity)))
+
+    def __len__(self):
+        return len(self._index)
+
+    def claim(self, hexid, now):
+        """Record for hexid, created (or recycled) on first sight; None if malformed."""
+        try:
+            key = icao_key(hexid)
+        except (ValueError, IndexError):
+            return None
+        rec = self._index.get(key)
+        if rec is not None:
+            self._index.move_to_end(key)
+        else:
+            if self._free:
+                rec = self._free.pop()
+            else:
+                _, rec = self._index.popitem(last=False)
+            self._index[key] = rec
+            self.kf_t[rec] = _NAN
+            self.warn_t[rec] = 0.0
+            self.orbit_warn_t[rec] = 0.0
+            self.orbit.reset(rec)
+        self.seen[rec] = now
+        return rec
+
+    def expire(self, now):
+        cutoff = now - TRACK_STATE_TTL_SEC
+        index = self._index
+        while index:
+            key, rec = next(iter(index.items()))
+            if self.seen[rec] >= cutoff:
+                break
+            del index[key]
+            self._free.append(rec)
+
+    def filter_update(self, rec, lat, lon, gs_kts, track, t):
+        """Fold one position report (plus gs/track if known) taken at time t.
+
+        Reports no newer than the last one fused are ignored, so a position
+        readsb repeats across snapshots is only counted once.
+        """
+        last = self.kf_t[rec]
+        if t <= last:
+            return
+        r_pos = KF_POS_SIGMA_MI ** 2
+        has_vel = gs_kts == gs_kts and track is not None
+        if has_vel:
+            speed = gs_kts * MPH_PER_KT / 3600
+            zvx = speed * math.sin(math.radians(track))
+            zvy = speed * math.cos(math.radians(track))
+            r_vel = (KF_VEL_SIGMA_MPH / 3600) ** 2
+
+        if not (t - last <= KF_RESET_GAP_SEC):      # first report, or a long gap
+            self.org_lat[rec] = lat
+            self.org_lon[rec] = lon
+            self.org_cos[rec] = math.cos(math.radians(lat))
+            p_vel = (KF_INIT_VEL_SIGMA_MPH / 3600) ** 2
+            vx, vy = (zvx, zvy) if has_vel else (0.0, 0.0)
+            pv = r_vel if has_vel else p_vel
+            self.kx[rec], self.kvx[rec] = 0.0, vx
+            self.ky[rec], self.kvy[rec] = 0.0, vy
+            self.kpx[rec] = self.kpy[rec] = r_pos
+            self.kpxv[rec] = self.kpyv[rec] = 0.0
+            self.kpvx[rec] = self.kpvy[rec] = pv
+            self.kf_t[rec] = t
+            return
+
+        dt = t - last
+        q = (KF_ACCEL_SIGMA_MPH_S / 3600) ** 2
+        zx = (lon - self.org_lon[rec]) * self.org_cos[rec] * MI_PER_DEG
+        zy = (lat - self.org_lat[rec]) * MI_PER_DEG
+        ax = _kf_predict(self.kx[rec], self.kvx[rec], self.kpx[rec],
+                         self.kpxv[rec], self.kpvx[rec], dt, q)
+        ay = _kf_predict(self.ky[rec], self.kvy[rec], self.kpy[rec],
+                         self.kpyv[rec], self.kpvy[rec], dt, q)
+        ax = _kf_correct_pos(*ax, zx, r_pos)
+        ay = _kf_correct_pos(*ay, zy, r_pos)
+        if has_vel:
+            ax = _kf_correct_vel(*ax, zvx, r_vel)
+            ay = _kf_correct_vel(*ay, zvy, r_vel)
+        self.kx[rec], self.kvx[rec], self.kpx[rec], self.kpxv[rec], self.kpvx[rec] = ax
+        self.ky[rec], self.kvy[rec], self.kpy[rec], self.kpyv[rec], self.kpvy[rec] = ay
+        self.kf_t[rec] = t
+
+    def relative(self, rec, my_lat, my_lon, now, own_vx=0.0, own_vy=0.0):
+        """(rx, ry, closing mph, closing 1-sigma) relative to own-ship, or None.
+
+        The filtered position is extrapolated to `now`, which must be the
+        epoch my_lat/my_lon describe, so both ends of the line of sight are
+        taken at the same instant.  rx/ry are east/north miles to the
+        aircraft; closing uses the velocity relative to own-ship (own_vx/
+        own_vy, mi/s) and is positive when the range is shrinking.
+        """
+        last = self.kf_t[rec]
+        if not (now - last <= KF_RESET_GAP_SEC):
+            return None
+        dt = now - last
+        vx, vy = self.kvx[rec], self.kvy[rec]
+        lat = self.org_lat[rec] + (self.ky[rec] + vy * dt) / MI_PER_DEG
+        lon = self.org_lon[rec] + (self.kx[rec] + vx * dt) / (self.org_cos[rec] * MI_PER_DEG)
+        rx = (lon - my_lon) * math.cos(math.radians(my_lat)) * MI_PER_DEG
+        ry = (lat - my_lat) * MI_PER_DEG
+        rng = math.hypot(rx, ry)
+        if rng < 1e-6:
+            return None             # overhead — line of sight is undefined
+        ux, uy = rx / rng, ry / rng
+        closing = -(ux * (vx - own_vx) + uy * (vy - own_vy)) * 3600
+        sd = math.sqrt(ux * ux * self.kpvx[rec] + uy * uy * self.kpvy[rec]) * 3600
+        return rx, ry, closing, sd
+
+    def range_rate(self, rec, my_lat, my_lon, now):
+        """Closing speed toward a fixed site in mph and its 1-sigma, or (None, None)."""
+        rel = self.relative(rec, my_lat, my_lon, now)
+        return (None, None) if rel is None else rel[2:]
+
+
+# ── Audio engine ───────────────────────────────────────────────────────────────
+def synth_tone(freq, dur_ms, rate=AUDIO_RATE):
+    """Mono s16le sine burst with a short linear fade at each end."""
+    samples = max(1, int(rate * dur_ms / 1000))
+    amp = 28000
+    data = array("h", [int(amp * math.sin(2 * math.pi * freq * i / rate))
+                       for i in range(samples)])
+    fade = min(200, samples // 4)
+    for i in range(fade):
+        data[i] = int(data[i] * i / fade)
+        data[-(i + 1)] = int(data[-(i + 1)] * i / fade)
+    return data.tobytes()
+
+
+class PcmOutput:
+    """One long-lived raw PCM player fed over its stdin.
+
+    pacat is preferred since it idles cleanly between alerts; aplay is the
+    fallback.  The player is started on first use and restarted if it
+    dies, so a beep costs a pipe write rather than a process spawn.
+    """
+    COMMANDS = (
+        ["pacat", "--raw", "--format=s16le", f"--rate={AUDIO_RATE}",
+         "--channels=1", "--latency-msec=40"],
+        ["aplay", "-q", "-t", "raw", "-f", "S16_LE", "-r", str(AUDIO_RATE), "-c", "1"],
+    )
+
+    def __init__(self, commands=COMMANDS):
+        self.commands = commands
+        self._proc = None
+
+    def write(self, pcm):
+        """Queue PCM for playback; False if no player could be run."""
+        for _ in range(2):
+            if self._proc is None or self._proc.poll() is not None:
+                self._proc = self._spawn()
+                if self._proc is None:
+                    return False
+            try:
+                self._proc.stdin.write(pcm)
+                self._proc.stdin.flush()
+                return True
+            except OSError:
+                self._proc = None   # player died — start a fresh one
+        return False
+
+    def _spawn(self):
+        for cmd in self.commands:
+            try:
+                return subprocess.Popen(cmd, stdin=subprocess.PIPE,
+                                        stdout=subprocess.DEVNULL,
+                                        stderr=subprocess.DEVNULL)
+            except FileNotFoundError:
+                continue
+        return None
+
+    def close(self):
+        if self._proc is not None:
+            try:
+                self._proc.stdin.close()
+            except OSError:
+                pass
+            self._proc = None
+
+
+class NullSink:
+    """Discards audio; for benchmarks and boxes without a sound device."""
+
+    def __init__(self):
+        self.bytes_written = 0
+
+    def write(self, pcm):
+        self.bytes_written += len(pcm)
+        return True
+
+    def close(self):
+        pass
+
+
+class FileSink:
+    """Appends the mixed s16le stream to a file, to check alerts by ear later."""
+
+    def __init__(self, path):
+        self._f = open(path, "ab")
+
+    def write(self, pcm):
+        self._f.write(pcm)
+        return True
+
+    def close(self):
+        self._f.close()
+
+
+def make_sink(spec):
+    """Sink for an AUDIO_SINK setting: "player", "null" or a file path."""
+    if spec == "player":
+        return PcmOutput()
+    if spec == "null":
+        return NullSink()
+    return FileSink(spec)
+
+
+class _Voice:
+    __slots__ = ("pcm", "pos", "prio", "t_submit")
+
+    def __init__(self, pcm, prio, t_submit):
+        self.pcm = pcm
+        self.pos = 0
+        self.prio = prio
+        self.t_submit = t_submit
+
+
+class AudioMixer:
+    """One long-lived thread that mixes alert audio into a single sink.
+
+    Two channels — "tone" and "speech" — play at once, so a tone sits
+    under the sentence that goes with it.  Within a channel, clips queue
+    by priority.  A clip more severe than anything playing or queued cuts
+    that audio off at the next block and discards the less severe
+    backlog, so a DANGER is never stuck behind a stale CAUTION.  Blocks
+    of MIXER_BLOCK_MS are paced to real time, at most MIXER_LEAD_MS ahead
+    of the sink, which bounds how late a preemption can be heard.
+    """
+    CHANNELS = ("tone", "speech")
+
+    def __init__(self, sink):
+        self.sink = sink
+        self.block = int(AUDIO_RATE * MIXER_BLOCK_MS / 1000)
+        self._cond = threading.Condition()
+        self._active = dict.fromkeys(self.CHANNELS)
+        self._queued = {ch: [] for ch in self.CHANNELS}   # heaps of (-prio, n, voice)
+        self._n = 0
+        self.running = True
+        self.preempted = 0
+        self.dropped = 0
+        self.last_latency_ms = None        # submit to first block in the sink
+        self.latency_ms = dict.fromkeys(self.CHANNELS)     # the same, per channel
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def backlog(self, channel, prio):
+        """True if channel already has MIXER_QUEUE_MAX clips at least as severe."""
+        with self._cond:
+            return sum(-p >= prio for p, _, _ in self._queued[channel]) >= MIXER_QUEUE_MAX
+
+    def play(self, pcm, prio, channel, t_submit=None):
+        voice = _Voice(pcm, prio, time.perf_counter() if t_submit is None else t_submit)
+        with self._cond:
+            for ch in self.CHANNELS:
+                v = self._active[ch]
+                if v is not None and v.prio < prio:
+                    self._active[ch] = None
+                    self.preempted += 1
+                q = self._queued[ch]
+                keep = [item for item in q if -item[0] >= prio]
+                if len(keep) != len(q):
+                    self.dropped += len(q) - len(keep)
+                    heapq.heapify(keep)
+                    self._queued[ch] = keep
+            q = self._queued[channel]
+            self._n += 1
+            heapq.heappush(q, (-prio, self._n, voice))
+            if len(q) > MIXER_QUEUE_MAX:
+                q.remove(max(q))           # least severe, newest
+                heapq.heapify(q)
+                self.dropped += 1
+            self._cond.notify()
+
+    def stop(self):
+        with self._cond:
+            self.running = False
+            self._cond.notify()
+        self.sink.close()
+
+    def _run(self):
+        n = self.block
+        deadline = None
+        while True:
+            with self._cond:
+                while self.running:
+                    for ch in self.CHANNELS:
+                        if self._active[ch] is None and self._queued[ch]:
+                            self._active[ch] = heapq.heappop(self._queued[ch])[2]
+                    if any(self._active.values()):
+                        break
+                    deadline = None
+                    self._cond.wait()
+                if not self.running:
+                    return
+                voices = [v for v in self._active.values() if v is not None]
+                started = [(ch, v) for ch, v in self._active.items()
+                           if v is not None and v.pos == 0]
+                block = self._mix(voices, n)
+                for ch, v in self._active.items():
+                    if v is not None and v.pos >= len(v.pcm):
+                        self._active[ch] = None
+            self.sink.write(block)
+            now = time.perf_counter()
+            for ch, v in started:
+                ms = (now - v.t_submit) * 1000
+                self.last_latency_ms = self.latency_ms[ch] = ms
+            # Pace to real time so a preemption is heard within the lead.
+            deadline = (now if deadline is None else deadline) + n / AUDIO_RATE
+            wait = deadline - MIXER_LEAD_MS / 1000 - time.perf_counter()
+            if wait > 0:
+                time.sleep(wait)
+
+    @staticmethod
+    def _mix(voices, n):
+        """Next n samples of every voice mixed together; advances them.
+
+        Overlapping voices are each halved, so two full-scale clips sum
+        without clipping and a tone sits audibly under the speech.
+        """
+        nbytes = 2 * n
+        if len(voices) == 1:
+            v = voices[0]
+            chunk = v.pcm[v.pos:v.pos + nbytes]
+            v.pos += nbytes
+            return chunk + bytes(nbytes - len(chunk))
+        if np is not None:
+            acc = np.zeros(n, dtype=np.int32)
+            for v in voices:
+                seg = np.frombuffer(v.pcm[v.pos:v.pos + nbytes], dtype=np.int16)
+                acc[:len(seg)] += seg >> 1
+                v.pos += nbytes
+            return np.clip(acc, -32768, 32767).astype(np.int16).tobytes()
+        acc = [0] * n
+        for v in voices:
+            seg = array("h", v.pcm[v.pos:v.pos + nbytes])
+            for i, x in enumerate(seg):
+                acc[i] += x >> 1
+            v.pos += nbytes
+        return array("h", [min(max(x, -32768), 32767) for x in acc]).tobytes()
+
+
+def _espeak_pcm(text):
+    """Synthesize text with espeak-ng to s16le at AUDIO_RATE, or b"" if it can't."""
+    try:
+        wav = subprocess.run(["espeak-ng", "-s", "150", "-p", "45", "-a", "200",
+                              "--stdout", text],
+                             stdout=subprocess.PIPE, stderr=subprocess.DEVNULL).stdout
+        with wave.open(io.BytesIO(wav)) as wf:
+            if (wf.getframerate(), wf.getsampwidth(), wf.getnchannels()) != (AUDIO_RATE, 2, 1):
+                return b""
+            return wf.readframes(wf.getnframes())
+    except (OSError, EOFError, wave.Error):
+        return b""
+
+
+_ONES = ("zero one two three four five six seven eight nine ten eleven twelve "
+         "thirteen fourteen fifteen sixteen seventeen eighteen nineteen").split()
+_TENS = "_ _ twenty thirty forty fifty sixty seventy eighty ninety".split()
+
+
+def _int_words(n):
+    if n < 20:
+        return [_ONES[n]]
+    if n < 100:
+        return [_TENS[n // 10]] + (_int_words(n % 10) if n % 10 else [])
+    if n < 1000:
+        return [_ONES[n // 100], "hundred"] + (_int_words(n % 100) if n % 100 else [])
+    return _int_words(n // 1000) + ["thousand"] + (_int_words(n % 1000) if n % 1000 else [])
+
+
+def spoken_number(value, decimals=0):
+    """Words for a number, as phrase fragments: 1.5 -> one point five."""
+    text = f"{abs(value):.{decimals}f}"
+    whole, _, frac = text.partition(".")
+    words = ["minus"] if value < 0 and float(text) else []
+    words += _int_words(int(whole))
+    if frac:
+        words += ["point"] + [_ONES[int(d)] for d in frac]
+    return words
+
+
+def _trim_silence(pcm, threshold=300):
+    """Drop the leading and trailing near-silence espeak pads every clip with."""
+    data = array("h", pcm)
+    start, end = 0, len(data)
+    while start < end and abs(data[start]) < threshold:
+        start += 1
+    while end > start and abs(data[end - 1]) < threshold:
+        end -= 1
+    return data[start:end].tobytes()
+
+
+class PhraseEngine:
+    """Builds spoken alerts from pre-rendered clips instead of whole sentences.
+
+    Every fixed fragment — alert words, number words, compass points — is
+    synthesized once in the background at startup and trimmed of espeak's
+    padding.  At alert time a phrase is the cached clips joined by short
+    gaps; only fragments never seen before (in practice, aircraft idents)
+    go to espeak, and those are then kept in a bounded LRU.  hits / misses
+    count fragment lookups.
+    """
+    FRAGMENTS = (["Danger", "Warning", "Caution", "Aircraft", "Circling aircraft",
+                  "miles", "feet", "closing", "ETA", "seconds",
+                  "point", "minus", "hundred", "thousand"]
+                 + _ONES + _TENS[2:] + [c.lower() for c in COMPASS_POINTS])
+    PAUSE = ","
+
+    def __init__(self, synth=_espeak_pcm):
+        self._synth = synth
+        self._clips = {}
+        self._idents = OrderedDict()
+        self._lock = threading.Lock()
+        self._word_gap = bytes(2 * int(AUDIO_RATE * 0.06))
+        self._pause = bytes(2 * int(AUDIO_RATE * 0.25))
+        self.hits = 0
+        self.misses = 0
+        self.render_ms = None              # time to assemble the last phrase
+        threading.Thread(target=self._prerender, daemon=True).start()
+
+    def _prerender(self):
+        for text in self.FRAGMENTS:
+            if text not in self._clips:
+                self._clips[text] = _trim_silence(self._synth(text))
+
+    def _clip(self, text):
+        pcm = self._clips.get(text)
+        if pcm is None:
+            with self._lock:
+                pcm = self._idents.get(text)
+                if pcm is not None:
+                    self._idents.move_to_end(text)
+        if pcm is not None:
+            self.hits += 1
+            return pcm
+        self.misses += 1
+        pcm = _trim_silence(self._synth(text))
+        with self._lock:
+            self._idents[text] = pcm
+            if len(self._idents) > PHRASE_IDENT_CACHE:
+                self._idents.popitem(last=False)
+        return pcm
+
+    def render(self, parts):
+        """PCM for a list of fragments, with PAUSE marking a longer gap."""
+        t0 = time.perf_counter()
+        out = []
+        for part in parts:
+            if part == self.PAUSE:
+                out.append(self._pause)
+            else:
+                if out and out[-1] is not self._pause:
+                    out.append(self._word_gap)
+                out.append(self._clip(part))
+        self.render_ms = (time.perf_counter() - t0) * 1000
+        return b"".join(out)
+
+
+class AudioEngine:
+    TONES = {                                  # freq Hz, ms, count, gap ms
+        "caution": (880,  120, 1, 0),
+        "warning": (1100, 150, 2, 60),
+        "danger":  (1400, 180, 3, 50),
+        "orbit":   (660,  200, 1, 0),
+    }
+    PRIORITY = {"orbit": 0, "caution": 1, "warning": 2, "danger": 3}
+
+    def __init__(self, sink=None, synth=_espeak_pcm):
+        self.mixer = AudioMixer(sink or make_sink(AUDIO_SINK))
+        self.phrases = PhraseEngine(synth)
+        # Alert tones are synthesized once, here, never per beep.
+        self._tones = {}
+        for freq, dur_ms, _, _ in self.TONES.values():
+            self._tone(freq, dur_ms)
+
+    def say(self, parts, level="caution"):
+        """Speak a phrase assembled by the PhraseEngine from cached clips."""
+        prio = self.PRIORITY[level]
+        if self.mixer.backlog("speech", prio):
+            return  # already saying enough at this severity — drop stale alert
+        t0 = time.perf_counter()
+        def _do():
+            pcm = self.phrases.render(parts)
+            if pcm:
+                self.mixer.play(pcm, prio, "speech", t0)
+        threading.Thread(target=_do, daemon=True).start()
+
+    @property
+    def beep_latency_ms(self):
+        """beep() to the tone's first block reaching the sink, last alert."""
+        return self.mixer.latency_ms["tone"]
+
+    def _tone(self, freq, dur_ms):
+        pcm = self._tones.get((freq, dur_ms))
+        if pcm is None:
+            pcm = self._tones[(freq, dur_ms)] = synth_tone(freq, dur_ms)
+        return pcm
+
+    def beep(self, freq=880, dur_ms=120, count=1, gap_ms=80, level="caution"):
+        t0 = time.perf_counter()
+        tone = self._tone(freq, dur_ms)
+        gap = bytes(2 * int(AUDIO_RATE * gap_ms / 1000))
+        self.mixer.play(gap.join([tone] * count), self.PRIORITY[level], "tone", t0)
+
+    def caution_tone(self):  self.beep(*self.TONES["caution"], level="caution")
+    def warning_tone(self):  self.beep(*self.TONES["warning"], level="warning")
+    def danger_tone(self):   self.beep(*self.TONES["danger"],  level="danger")
+    def orbit_tone(self):    self.beep(*self.TONES["orbit"],   level="orbit")
+
+
+def set_thresholds(field_elev_ft=None, max_alt_ft=None, caution_mi=None):
+    """Change the thresholds the engine reads each cycle; returns what changed."""
+    global FIELD_ELEV_FT, MAX_ALT_FT, RING_CAUTION_MI
+    changed = {}
+    if field_elev_ft is not None and field_elev_ft != FIELD_ELEV_FT:
+        FIELD_ELEV_FT = changed["field_elev_ft"] = field_elev_ft
+    if max_alt_ft is not None and max_alt_ft != MAX_ALT_FT:
+        MAX_ALT_FT = changed["max_alt_ft"] = max_alt_ft
+    if caution_mi is not None and caution_mi != RING_CAUTION_MI:
+        RING_CAUTION_MI = changed["caution_mi"] = caution_mi
+    return changed
+
+
+# ── Threat engine ──────────────────────────────────────────────────────────────
+@dataclass(frozen=True)
+class ThreatSnapshot:
+    """Immutable result of one engine cycle, handed to the display as a whole."""
+    seq: int
+    gps_ok: bool
+    my_lat: Optional[float]
+    my_lon: Optional[float]
+    sdr_ok: bool
+    sdr_status: str
+    total_ac_seen: int
+    table: Optional[AircraftTable]   # frozen copy of the engine's table
+    threats: array          # table slots, sorted by dist_mi
+    safe_ac: array          # table slots, sorted by dist_mi
+    stage_ms: tuple         # (read, geometry, classify) for this cycle
+    published: float        # time.time() at hand-off, for display lag
+
+
+class ThreatEngine:
+    """GPS, ingest, classification and alerting on worker threads.
+
+    Nothing here touches Tk.  Each cycle builds a ThreatSnapshot and
+    publishes it by a single reference assignment to `latest` — the display
+    thread reads that attribute whenever it likes, so the hand-off never
+    blocks either side.  Log lines travel separately through the `log`
+    deque so none are lost when the display skips a snapshot.  The audio
+    engine can be passed in; by default _make_audio() builds one.
+    """
+
+    def __init__(self, on_publish=None, audio=None):
+        self.running = False
+        self.audio = audio if audio is not None else self._make_audio()
+        self.tracks = TrackStore()
+        self.reg_db = load_reg_db()
+        self.latest = None
+        self.log = deque(maxlen=200)          # (timestamp, msg, level)
+        self._on_publish = on_publish
+        self._seq = 0
+
+        # Own-ship state: the GPS thread replaces this immutable GpsFix (or
+        # None) by a single assignment, so a cycle always reads a whole fix.
+        self.gps_fix = None
+        self._gps_last = None           # last good fix, kept for display when lost
+        self.gps = None
+
+        self.table = AircraftTable()
+        self._watch = []                # (slot, rec) threats nearing the DANGER ring
+        self._clock = ClockOffset()     # readsb's clock to ours
+        self._fields = {}               # last cycle's published fields
+        self.last_danger_beep = 0
+
+    def _make_audio(self):
+        return AudioEngine()
+
+    def start(self):
+        self.running = True
+        self.sbs_feed = None
+        self.json_watch = None
+        self._ingest_wake = None
+        if INGEST_MODE == "sbs":
+            self._ingest_wake = _Waker()
+            self.sbs_feed = SbsFeed(SBS_HOST, SBS_PORT,
+                                    on_position=self._ingest_wake.wake)
+            self.sbs_feed.start()
+        else:
+            self.json_watch = AircraftJsonWatcher(AIRCRAFT_JSON)
+        self._start_gps_thread()
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def stop(self):
+        self.running = False
+        if self.sbs_feed:
+            self.sbs_feed.stop()
+        if self.gps:
+            self.gps.stop()
+
+    def gps_state(self):
+        fix = self.gps_fix
+        if fix is not None:
+            return fix.lat, fix.lon, True
+        last = self._gps_last
+        return (last.lat, last.lon, False) if last else (None, None, False)
+
+    def set_thresholds(self, **changes):
+        return set_thresholds(**changes)
+
+    def _emit(self, msg, level):
+        self.log.append((datetime.now().strftime("%H:%M:%S"), msg, level))
+
+    # ── GPS thread ─────────────────────────────────────────────────────────────
+    def _start_gps_thread(self):
+        def on_fix(fix):
+            if fix is not None:
+                self._gps_last = fix
+            self.gps_fix = fix
+        def run():
+            fix_gps_setup()
+            self.gps.run()
+        if GPS_SOURCE == "serial":
+            self.gps = NmeaReader(on_fix, GPS_DEVICE, GPS_BAUD, GPS_UBX)
+            run = self.gps.run
+        else:
+            self.gps = GpsdClient(on_fix)
+        threading.Thread(target=run, daemon=True).start()
+
+    # ── Worker loop ────────────────────────────────────────────────────────────
+    def _run(self):
+        """Wait for fresh data (or the SAMPLE_SEC tick) and run one cycle.
+
+        While any threat is near the DANGER ring the wait is cut into
+        PREDICT_FRAME_SEC steps, each checking the dead-reckoned ranges.
+        """
+        last = 0.0
+        tick = time.time() + SAMPLE_SEC
+        while self.running:
+            if self._ingest_wake is not None:
+                fd = self._ingest_wake.fileno()
+            else:
+                fd = self.json_watch.fileno() if self.json_watch.watching else None
+            wait = max(tick - time.time(), 0.0)
+            if self._watch:
+                wait = min(wait, PREDICT_FRAME_SEC)
+            ready = False
+            if fd is not None:
+                ready = bool(select.select([fd], [], [], wait)[0])
+            else:
+                time.sleep(wait)
+            if not self.running:
+                return
+            if not ready and time.time() < tick:
+                try:
+                    self._predict_danger(time.time())
+                except Exception as e:
+                    self._emit(f"ENGINE ERROR: {e}", "danger")
+                continue
+            from_event = False
+            if ready and self._ingest_wake is not None:
+                # Coalesce bursts of pushed positions into one cycle.
+                wait = last + PUSH_MIN_INTERVAL_SEC - time.time()
+                if wait > 0:
+                    time.sleep(wait)
+                self._ingest_wake.drain()
+            elif ready:
+                from_event = self.json_watch.drain_events()
+            last = time.time()
+            tick = last + SAMPLE_SEC
+            try:
+                self._cycle(from_event)
+            except Exception as e:
+                self._emit(f"ENGINE ERROR: {e}", "danger")
+
+    def _read_snapshot(self, from_event):
+        """Return the snapshot to process, or None if there is nothing new."""
+        if self.sbs_feed is None:
+            if self.json_watch.watching and not from_event:
+                return None  # inotify drives reads; the tick is housekeeping only
+            return self.json_watch.poll()
+        if not self.sbs_feed.connected:
+            raise ConnectionError("SBS feed not connected")
+        return self.sbs_feed.snapshot()
+
+    def _sdr_status(self):
+        w = self.json_watch
+        if w is None or w.read_ms is None:
+            return "SDR: OK"
+        return (f"SDR: OK #{w.snapshots_seen} dup {w.duplicates_skipped} "
+                f"{w.age_ms:.0f}ms")
+
+    def _publish(self, **fields):
+        self._seq += 1
+        fields.setdefault("sdr_ok", False)
+        fields.setdefault("sdr_status", "SDR: --")
+        fields.setdefault("total_ac_seen", 0)
+        fields.setdefault("table", None)
+        fields.setdefault("threats", array("l"))
+        fields.setdefault("safe_ac", array("l"))
+        fields.setdefault("stage_ms", (0.0, 0.0, 0.0))
+        self._fields = fields
+        self.latest = ThreatSnapshot(seq=self._seq, published=time.time(), **fields)
+        if self._on_publish:
+            self._on_publish()
+
+    def _cycle(self, from_event=False):
+        now = time.time()
+        fix = self.gps_fix
+        my_lat, my_lon, gps_ok = self.gps_state()
+
+        if fix is None:
+            # Closing speed comes from each target's filtered velocity, not
+            # from differencing own-ship ranges, so a GPS gap leaves the
+            # trackers valid and nothing needs discarding here.
+            self._watch = []
+            self._publish(gps_ok=False, my_lat=my_lat, my_lon=my_lon)
+            return
+
+        t0 = time.perf_counter()
+        try:
+            snap = self._read_snapshot(from_event)
+        except Exception:
+            self._watch = []
+            self._publish(gps_ok=True, my_lat=my_lat, my_lon=my_lon,
+                          sdr_status="SDR: NO DATA")
+            return
+        if snap is None:
+            return  # same readsb write already processed — keep the last snapshot
+        t1 = time.perf_counter()
+
+        # Snapshot the thresholds so they cannot change mid-loop if the UI
+        # edits them while we are iterating.
+        ring_caution = RING_CAUTION_MI
+        max_alt_ft   = MAX_ALT_FT
+        field_elev   = FIELD_ELEV_FT
+        active_hexids = set()
+        # Filter times stay on readsb's clock so a remote aggregator's clock
+        # offset cannot age every report out of the filter.
+        snap_t = snap.now or now
+        # Own-ship moves too: dead-reckon the fix to the snapshot epoch,
+        # carried onto our clock, so every range below differences two
+        # positions taken at one instant, and closing speeds use velocity
+        # relative to us.
+        offset = self._clock.update(snap.now, now)
+        my_lat, my_lon, own_vx, own_vy = fix.at(snap_t + offset)
+        tracks = self.tracks
+        tbl = self.table
+        threat_slots = []
+        safe_slots = []
+
+        # Two-stage range gate: a degree box discards far traffic, then exact
+        # great-circle geometry runs only for the survivors.
+        cand = range_gate(snap.lat, snap.lon, my_lat, my_lon, ring_caution)
+        dists, bears, to_mes = batch_geometry(snap.lat, snap.lon, my_lat, my_lon, cand)
+        t2 = time.perf_counter()
+
+        # Pass 1: advance every in-range aircraft's trackers and gather the
+        # relative-motion columns the CPA solve needs.
+        rows = []
+        c_dist, c_bear, c_vx, c_vy = array("d"), array("d"), array("d"), array("d")
+        c_agl, c_vrate = array("d"), array("d")
+        for k, i in enumerate(cand):
+            dist = float(dists[k])
+            if dist > ring_caution:
+                continue
+            hexid = snap.hexid[i]
+            track = snap.track[i]
+            if track != track: track = None   # NaN marks a missing field
+            rec = tracks.claim(hexid, now)
+            if rec is None:
+                continue
+            active_hexids.add(hexid)
+            is_orbiting = tracks.orbit.update(rec, track, now)
+
+            tracks.filter_update(rec, snap.lat[i], snap.lon[i], snap.gs[i], track,
+                                 snap_t - snap.seen_pos[i])
+            rel = tracks.relative(rec, my_lat, my_lon, snap_t, own_vx, own_vy)
+            if rel is None:
+                closing_mph = closing_sd = None
+                c_dist.append(dist)
+                c_bear.append(float(bears[k]))
+                c_vx.append(_NAN)
+                c_vy.append(_NAN)
+            else:
+                # CPA starts from the filtered position at the epoch, not the
+                # last report, which may be a second or more old.
+                rx, ry, closing_mph, closing_sd = rel
+                c_dist.append(math.hypot(rx, ry))
+                c_bear.append(math.degrees(math.atan2(rx, ry)) % 360)
+                c_vx.append(tracks.kvx[rec] - own_vx)
+                c_vy.append(tracks.kvy[rec] - own_vy)
+            # Report-time position relative to where own-ship was then, and
+            # the gs/track velocity relative to own-ship, for dead reckoning
+            # between snapshots.  The report time is the snapshot epoch less
+            # seen_pos, carried onto our clock like own-ship's epoch above,
+            # not our read time: that would add the read delay to every age.
+            age = snap.seen_pos[i]
+            b = math.radians(float(bears[k]))
+            gs = snap.gs[i]
+            if track is None or gs != gs:
+                vx = vy = _NAN
+            else:
+                v = gs * MPH_PER_KT / 3600
+                vx = v * math.sin(math.radians(track)) - own_vx
+                vy = v * math.cos(math.radians(track)) - own_vy
+            motion = (dist * math.sin(b) + own_vx * age,
+                      dist * math.cos(b) + own_vy * age, vx, vy, snap_t + offset - age)
+            rows.append((i, rec, dist, track, is_orbiting, closing_mph, closing_sd, motion))
+            c_agl.append(int(snap.alt[i]) - field_elev)
+            c_vrate.append(snap.vrate[i])
+
+        # Pass 2: one batched closest-point-of-approach solve for everyone.
+        t_cpa, miss_mi, agl_cpa, t_enter = batch_cpa(
+            c_dist, c_bear, c_vx, c_vy, c_agl, c_vrate, RING_WARN_MI)
+
+        # Pass 3: classify on the predicted miss, fill the table, alert.
+        watch = []
+        for j, (i, rec, dist, track, is_orbiting, closing_mph, closing_sd,
+                (rx, ry, vx, vy, pos_t)) in enumerate(rows):
+            hexid = snap.hexid[i]
+            alt   = snap.alt[i]
+            # Only count an aircraft as closing when the filter is confident
+            # of it — first contact with gs/track qualifies immediately, a
+            # position-only track needs a few reports to tighten up.
+            closing_ok = (closing_mph is not None and
+                          closing_mph - KF_CONFIDENCE_Z * closing_sd >= MIN_CLOSING_MPH)
+
+            tail    = lookup_tail(self.reg_db, hexid)
+            flight  = snap.flight[i]
+            bear    = c_bear[j]
+            alt_agl = c_agl[j]
+            cpa_t   = float(t_cpa[j])
+            cpa_mi  = float(miss_mi[j])
+            cpa_agl = float(agl_cpa[j])
+            eta_sec = float(t_enter[j])
+
+            is_threat = False
+            if closing_ok:
+                if track is not None:
+                    # Score on where the aircraft will pass, not where it is:
+                    # a threat must come within the warning ring, low enough,
+                    # soon enough.
+                    is_threat = (cpa_t <= CPA_LOOKAHEAD_SEC and
+                                 cpa_mi <= RING_WARN_MI and
+                                 cpa_agl <= max_alt_ft)
+                elif dist <= RING_WARN_MI and alt <= (max_alt_ft + field_elev):
+                    # No heading data — only flag as threat when already inside
+                    # the warning ring; beyond that we cannot distinguish a
+                    # closing aircraft from a vehicle on a nearby road.
+                    is_threat = True
+
+            # Rings are checked on the range dead-reckoned to now, not the
+            # report, which may be a second or more old.
+            if vx == vx:
+                dt = min(max(now - pos_t, 0.0), PREDICT_MAX_SEC)
+                dist = math.hypot(rx + vx * dt, ry + vy * dt)
+            if dist <= RING_DANGER_MI:   level = 2
+            elif dist <= RING_WARN_MI:   level = 1
+            else:                        level = 0
+
+            slot = tbl.upsert(hexid)
+            tbl.lat[slot]      = snap.lat[i]
+            tbl.lon[slot]      = snap.lon[i]
+            tbl.alt[slot]      = alt
+            tbl.dist[slot]     = dist
+            tbl.track[slot]    = snap.track[i]
+            tbl.gs[slot]       = snap.gs[i]
+            tbl.closing[slot]  = _NAN if closing_mph is None else closing_mph
+            tbl.closing_sd[slot] = _NAN if closing_sd is None else closing_sd
+            tbl.eta[slot]      = eta_sec
+            tbl.cpa_t[slot]    = cpa_t
+            tbl.cpa_mi[slot]   = cpa_mi
+            tbl.cpa_agl[slot]  = cpa_agl
+            tbl.bearing[slot]  = bear
+            tbl.agl[slot]      = alt_agl
+            tbl.level[slot]    = level if is_threat else 0
+            tbl.orbiting[slot] = is_orbiting
+            tbl.rx[slot]       = rx
+            tbl.ry[slot]       = ry
+            tbl.vx[slot]       = vx
+            tbl.vy[slot]       = vy
+            tbl.pos_t[slot]    = pos_t
+            if tbl.flight[slot] != flight:
+                tbl.flight[slot] = flight
+            tbl.tail[slot]     = tail
+            if is_threat:
+                threat_slots.append(slot)
+                self._handle_threat_alerts(Aircraft(tbl, slot), rec, now)
+                # Watch threats that dead reckoning could carry into the
+                # DANGER ring, so _predict_danger() can alert between polls.
+                if (level < 2 and vx == vx and
+                        dist - RING_DANGER_MI <= math.hypot(vx, vy) * PREDICT_MAX_SEC):
+                    watch.append((slot, rec))
+            else:
+                safe_slots.append(slot)
+            if is_orbiting:
+                self._handle_orbit_alert(Aircraft(tbl, slot), rec, now, bear)
+
+        # Rows leave the display table with the caution ring; their history
+        # stays in the track store until it ages out.
+        for hexid in [h for h in tbl.slot_of if h not in active_hexids]:
+            tbl.release(hexid)
+        tracks.expire(now)
+        threat_slots.sort(key=tbl.dist.__getitem__)
+        safe_slots.sort(key=tbl.dist.__getitem__)
+        self._watch = watch
+        t3 = time.perf_counter()
+
+        self._publish(gps_ok=True, my_lat=my_lat, my_lon=my_lon,
+                      sdr_ok=True, sdr_status=self._sdr_status(),
+                      total_ac_seen=snap.total, table=tbl.freeze(),
+                      threats=array("l", threat_slots), safe_ac=array("l", safe_slots),
+                      stage_ms=((t1 - t0) * 1000, (t2 - t1) * 1000, (t3 - t2) * 1000))
+
+    def _predict_danger(self, now):
+        """Raise watched threats to DANGER as their dead-reckoned range crosses the ring.
+
+        Runs on the worker thread between cycles and touches only the
+        handful of threats _cycle() put on the watch list, so its cost does
+        not grow with the traffic on the scope.
+        """
+        tbl = self.table
+        crossed, watch = [], []
+        for slot, rec in self._watch:
+            dt = max(now - tbl.pos_t[slot], 0.0)
+            if dt > PREDICT_MAX_SEC:
+                continue                # too stale to carry further
+            dist = math.hypot(tbl.rx[slot] + tbl.vx[slot] * dt,
+                              tbl.ry[slot] + tbl.vy[slot] * dt)
+            if dist <= RING_DANGER_MI:
+                crossed.append((slot, rec, dist))
+            else:
+                watch.append((slot, rec))
+        self._watch = watch
+        if not crossed:
+            return
+        for slot, rec, dist in crossed:
+            tbl.dist[slot] = dist
+            tbl.level[slot] = 2
+            self._handle_threat_alerts(Aircraft(tbl, slot), rec, now)
+        fields = self._fields
+        self._publish(**{**fields, "table": tbl.freeze(),
+                         "threats": array("l", sorted(fields["threats"],
+                                                      key=tbl.dist.__getitem__))})
+
+    # ── Alert handlers ─────────────────────────────────────────────────────────
+    def _handle_orbit_alert(self, ac, rec, now, bearing):
+        if now - self.tracks.orbit_warn_t[rec] >= ORBIT_COOLDOWN_SEC:
+            compass = bearing_to_compass(bearing)
+            msg = f"SKY CIRCLE: {ac.ident}  {ac.dist_mi:.2f}mi  {compass}  {ac.alt_ft}ft"
+            self._emit(msg, "orbit")
+            self.audio.orbit_tone()
+            self.audio.say(
+                ["Caution", ",", "Circling aircraft", ac.ident, ",",
+                 *spoken_number(ac.dist_mi, 1), "miles", ",", compass.lower()],
+                level="orbit")
+            self.tracks.orbit_warn_t[rec] = now
+
+    def _handle_threat_alerts(self, ac, rec, now):
+        warn_t = self.tracks.warn_t
+        ident = ac.ident
+        if ac.threat_level == 2:
+            if now - self.last_danger_beep >= DANGER_COOLDOWN_SEC:
+                self._emit(f"DANGER: {ident}  {ac.dist_mi:.2f}mi  {ac.alt_ft}ft", "danger")
+                self.audio.danger_tone()
+                self.audio.say(
+                    ["Danger", ",", "Aircraft", ident, ",",
+                     *spoken_number(ac.dist_mi, 1), "miles", ",",
+                     *spoken_number(ac.alt_ft), "feet"], level="danger")
+                self.last_danger_beep = now
+                warn_t[rec] = now
+            return
+        if ac.threat_level == 1:
+            if now - warn_t[rec] >= WARN_COOLDOWN_SEC:
+                eta_s = ([",", "ETA", *spoken_number(int(ac.eta_1mi_sec)), "seconds"]
+                         if ac.eta_1mi_sec and ac.eta_1mi_sec < 120 else [])
+                self._emit(
+                    f"WARNING: {ident}  {ac.dist_mi:.2f}mi  {ac.alt_ft}ft  {ac.eta_str}",
+                    "warning")
+                self.audio.warning_tone()
+                self.audio.say(
+                    ["Warning", ",", "Aircraft", ident, ",",
+                     *spoken_number(ac.dist_mi, 1), "miles", ",",
+                     *spoken_number(ac.alt_ft), "feet", *eta_s], level="warning")
+                warn_t[rec] = now
+            return
+        if now - warn_t[rec] >= WARN_COOLDOWN_SEC:
+            self._emit(
+                f"CAUTION: {ident}  {ac.dist_mi:.2f}mi  {ac.alt_ft}ft  {ac.closing_str}",
+                "caution")
+            self.audio.caution_tone()
+            self.audio.say(
+                ["Caution", ",", "Aircraft", ident, ",",
+                 *spoken_number(ac.dist_mi, 1), "miles", ",",
+                 *spoken_number(ac.alt_ft), "feet", ",", "closing"], level="caution")
+            warn_t[rec] = now
+
+
+# ── Fleet evaluation ───────────────────────────────────────────────────────────
+@dataclass(frozen=True)
+class Observer:
+    """One fixed site with its own rings and ceiling."""
+    name: str
+    lat: float
+    lon: float
+    caution_mi: float
+    warn_mi: float
+    danger_mi: float
+    max_alt_ft: float
+    field_elev_ft: float
+
+
+def load_observers(path):
+    """Read a JSON list of sites; omitted thresholds take the global defaults.
+
+    Each entry needs "name", "lat" and "lon" and may set "caution_mi",
+    "warn_mi", "danger_mi", "max_alt_ft" and "field_elev_ft".
+    """
+    with open(path) as f:
+        entries = json.load(f)
+    return [Observer(name=str(e["name"]), lat=float(e["lat"]), lon=float(e["lon"]),
+                     caution_mi=float(e.get("caution_mi", RING_CAUTION_MI)),
+                     warn_mi=float(e.get("warn_mi", RING_WARN_MI)),
+                     danger_mi=float(e.get("danger_mi", RING_DANGER_MI)),
+                     max_alt_ft=float(e.get("max_alt_ft", MAX_ALT_FT)),
+                     field_elev_ft=float(e.get("field_elev_ft", FIELD_ELEV_FT)))
+            for e in entries]
+
+
+@dataclass(frozen=True)
+class FleetSnapshot:
+    """Immutable result of one fleet cycle: per-site threats, nearest first."""
+    seq: int
+    sdr_status: str
+    total_ac_seen: int
+    sites: tuple            # per observer: tuple of (hexid, level, dist_mi, cpa_mi, cpa_sec)
+    stage_ms: tuple         # (read, geometry, classify) for this cycle
+    published: float
+
+
+class FleetEngine(ThreatEngine):
+    """Evaluates many fixed observers against one shared feed.
+
+    The snapshot is parsed and every aircraft's filter advanced once per
+    cycle; only the site-dependent parts — range, bearing, closing speed
+    and CPA — are computed per (site, aircraft) pair, with the geometry as
+    one observers × aircraft matrix.  Alerts go to the log prefixed with
+    the site name; there is no own-ship GPS and no audio.
+    """
+
+    def __init__(self, observers, on_publish=None):
+        super().__init__(on_publish)
+        self.observers = list(observers)
+        self._obs_lat = [o.lat for o in self.observers]
+        self._obs_lon = [o.lon for o in self.observers]
+        self._alert_t = {}                    # (site index, hexid) -> last alert time
+
+    def _make_audio(self):
+        return None  # log-only: never start the mixer or render phrases
+
+    def _start_gps_thread(self):
+        pass  # sites are fixed — nothing to track
+
+    def _publish(self, **fields):
+        self._seq += 1
+        fields.setdefault("sdr_status", "SDR: --")
+        fields.setdefault("total_ac_seen", 0)
+        fields.setdefault("sites", ((),) * len(self.observers))
+        fields.setdefault("stage_ms", (0.0, 0.0, 0.0))
+        self.latest = FleetSnapshot(seq=self._seq, published=time.time(), **fields)
+        if self._on_publish:
+            self._on_publish()
+
+    def _cycle(self, from_event=False):
+        now = time.time()
+        t0 = time.perf_counter()
+        try:
+            snap = self._read_snapshot(from_event)
+        except Exception:
+            self._publish(sdr_status="SDR: NO DATA")
+            return
+        if snap is None:
+            return
+        t1 = time.perf_counter()
+
+        observers = self.observers
+        snap_t = snap.now or now
+        tracks = self.tracks
+
+        # Union of every site's range gate; with many sites the snapshot's
+        # grid index keeps each gate from rescanning the whole feed.
+        grid = snap.grid()
+        gates = [range_gate(snap.lat, snap.lon, o.lat, o.lon, o.caution_mi, grid)
+                 for o in observers]
+        if np is not None:
+            cand = np.unique(np.concatenate(gates)) if gates else np.arange(0)
+        else:
+            cand = array("l", sorted(set().union(*gates)))
+        dist, bear = observer_matrix(snap.lat, snap.lon, self._obs_lat, self._obs_lon, cand)
+        t2 = time.perf_counter()
+
+        # Pass 1: advance each candidate's filter once, whichever sites see it.
+        recs = []
+        for i in cand:
+            rec = tracks.claim(snap.hexid[i], now)
+            if rec is not None:
+                track = snap.track[i]
+                tracks.filter_update(rec, snap.lat[i], snap.lon[i], snap.gs[i],
+                                     None if track != track else track,
+                                     snap_t - snap.seen_pos[i])
+            recs.append(rec)
+
+        # Pass 2: gather every (site, aircraft) pair inside that site's
+        # caution ring and solve all their CPAs in one batch.
+        pairs = []
+        c_dist, c_bear, c_vx, c_vy = array("d"), array("d"), array("d"), array("d")
+        c_agl, c_vrate, c_ring = array("d"), array("d"), array("d")
+        for n, o in enumerate(observers):
+            row_d, row_b = dist[n], bear[n]
+            if np is not None:
+                near = np.flatnonzero(row_d <= o.caution_mi).tolist()
+            else:
+                near = [k for k, d in enumerate(row_d) if d <= o.caution_mi]
+            for k in near:
+                rec = recs[k]
+                if rec is None:
+                    continue
+                i = cand[k]
+                closing, sd = tracks.range_rate(rec, o.lat, o.lon, snap_t)
+                pairs.append((n, i, closing, sd))
+                c_dist.append(float(row_d[k]))
+                c_bear.append(float(row_b[k]))
+                c_vx.append(_NAN if closing is None else tracks.kvx[rec])
+                c_vy.append(_NAN if closing is None else tracks.kvy[rec])
+                c_agl.append(snap.alt[i] - o.field_elev_ft)
+                c_vrate.append(snap.vrate[i])
+                c_ring.append(o.warn_mi)
+        t_cpa, miss_mi, agl_cpa, _ = batch_cpa(c_dist, c_bear, c_vx, c_vy,
+                                               c_agl, c_vrate, c_ring)
+
+        # Pass 3: classify each pair against its own site's thresholds.
+        sites = [[] for _ in observers]
+        for j, (n, i, closing, sd) in enumerate(pairs):
+            o = observers[n]
+            d = c_dist[j]
+            if closing is None or closing - KF_CONFIDENCE_Z * sd < MIN_CLOSING_MPH:
+                continue
+            cpa_t, cpa_mi = float(t_cpa[j]), float(miss_mi[j])
+            if snap.track[i] == snap.track[i]:
+                if not (cpa_t <= CPA_LOOKAHEAD_SEC and cpa_mi <= o.warn_mi
+                        and float(agl_cpa[j]) <= o.max_alt_ft):
+                    continue
+            elif not (d <= o.warn_mi and c_agl[j] <= o.max_alt_ft):
+                continue
+            level = 2 if d <= o.danger_mi else 1 if d <= o.warn_mi else 0
+            hexid = snap.hexid[i]
+            sites[n].append((hexid, level, d, cpa_mi, cpa_t))
+            self._site_alert(n, hexid, snap.flight[i], level, d, snap.alt[i], now)
+        for rows in sites:
+            rows.sort(key=lambda r: r[2])
+        cooldown = max(WARN_COOLDOWN_SEC, DANGER_COOLDOWN_SEC)
+        for key in [k for k, t in self._alert_t.items() if now - t >= cooldown]:
+            del self._alert_t[key]
+        tracks.expire(now)
+        t3 = time.perf_counter()
+
+        self._publish(sdr_status=self._sdr_status(), total_ac_seen=snap.total,
+                      sites=tuple(tuple(rows) for rows in sites),
+                      stage_ms=((t1 - t0) * 1000, (t2 - t1) * 1000, (t3 - t2) * 1000))
+
+    def _site_alert(self, n, hexid, flight, level, dist, alt, now):
+        key = (n, hexid)
+        cooldown = DANGER_COOLDOWN_SEC if level == 2 else WARN_COOLDOWN_SEC
+        if now - self._alert_t.get(key, 0.0) < cooldown:
+            return
+        tail = lookup_tail(self.reg_db, hexid)
+        ident = (tail + (f" {flight}" if flight else "")) if tail else flight or hexid.upper()
+        label = ("CAUTION", "WARNING", "DANGER")[level]
+        self._emit(f"{self.observers[n].name}: {label}: {ident}  {dist:.2f}mi  {int(alt)}ft",
+                   label.lower())
+        self._alert_t[key] = now
+
+
+def run_fleet(observers):
+    """Run a FleetEngine without the display, printing its log to stdout."""
+    engine = FleetEngine(observers)
+    engine.start()
+    try:
+        while True:
+            time.sleep(SAMPLE_SEC)
+            while engine.log:
+                ts, msg, _ = engine.log.popleft()
+                print(f"[{ts}] {msg}", flush=True)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        engine.stop()
+
+
+# ── Engine socket ──────────────────────────────────────────────────────────────
+# Frames on the engine socket are a kind byte and a little-endian payload
+# length.  "S" carries a ThreatSnapshot, "L" a log line and "T" (display to
+# engine) a threshold change; log lines and thresholds are JSON.
+_FRAME = struct.Struct("<cI")
+_HEAD_LEN = struct.Struct("<I")
+
+
+def _frame(kind, payload):
+    return _FRAME.pack(kind, len(payload)) + payload
+
+
+def encode_snapshot(snap):
+    """ThreatSnapshot as an "S" payload: a JSON header, then raw table columns."""
+    t = snap.table
+    head = {"seq": snap.seq, "gps_ok": snap.gps_ok,
+            "my_lat": snap.my_lat, "my_lon": snap.my_lon,
+            "sdr_ok": snap.sdr_ok, "sdr_status": snap.sdr_status,
+            "total_ac_seen": snap.total_ac_seen, "stage_ms": snap.stage_ms,
+            "published": snap.published,
+            "threats": snap.threats.tolist(), "safe_ac": snap.safe_ac.tolist()}
+    cols = []
+    if t is not None:
+        head.update(hexid=t.hexid, flight=t.flight, tail=t.tail)
+        cols = [getattr(t, name).tobytes()
+                for name in AircraftTable._FLOAT_COLS + AircraftTable._BYTE_COLS]
+    head = json.dumps(head, separators=(",", ":")).encode()
+    return b"".join([_HEAD_LEN.pack(len(head)), head] + cols)
+
+
+def decode_snapshot(payload):
+    (n,) = _HEAD_LEN.unpack_from(payload)
+    head = _json_loads(payload[4:4 + n])
+    table = None
+    if "hexid" in head:
+        table = AircraftTable.__new__(AircraftTable)
+        table._free = []
+        table.hexid, table.flight, table.tail = head.pop("hexid"), head.pop("flight"), head.pop("tail")
+        table.slot_of = {h: slot for slot, h in enumerate(table.hexid) if h is not None}
+        pos, rows = 4 + n, len(table.hexid)
+        for name in AircraftTable._FLOAT_COLS + AircraftTable._BYTE_COLS:
+            col = array("d" if name in AircraftTable._FLOAT_COLS else "b")
+            end = pos + rows * col.itemsize
+            col.frombytes(payload[pos:end])
+            setattr(table, name, col)
+            pos = end
+    head["threats"] = array("l", head["threats"])
+    head["safe_ac"] = array("l", head["safe_ac"])
+    head["stage_ms"] = tuple(head["stage_ms"])
+    return ThreatSnapshot(table=table, **head)
+
+
+class _Client:
+    __slots__ = ("sock", "out", "inbuf", "seq")
+
+    def __init__(self, sock):
+        self.sock = sock
+        self.out = bytearray()
+        self.inbuf = bytearray()
+        self.seq = 0                # last snapshot queued to this client
+
+
+class SnapshotServer:
+    """Serves an engine's snapshots and log lines to display clients.
+
+    Runs on its own thread.  The engine's publish callback only wakes it;
+    the newest snapshot is encoded once and queued to each client whose
+    previous one has gone out, so a client that falls behind skips to the
+    latest instead of queueing every snapshot it missed, and a stalled
+    display never holds up detection.  Log lines are queued to everyone;
+    a client that lets CLIENT_MAX_BACKLOG pile up is disconnected.
+    Threshold changes sent back by a client are applied to the engine.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self._wake = _Waker()
+        self._clients = {}
+        self._sel = selectors.DefaultSelector()
+        try:
+            os.unlink(path)
+        except FileNotFoundError:
+            pass
+        self._lsock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self._lsock.bind(path)
+        self._lsock.listen(8)
+        self._lsock.setblocking(False)
+        self._sel.register(self._lsock, selectors.EVENT_READ)
+        self._sel.register(self._wake, selectors.EVENT_READ)
+
+    def publish(self):
+        self._wake.wake()
+
+    def serve(self, engine):
+        """Run until the engine stops; log lines are echoed to stdout."""
+        sent_seq, frame = 0, b""
+        while engine.running:
+            for key, events in self._sel.select(SAMPLE_SEC):
+                if key.fileobj is self._lsock:
+                    self._accept()
+                elif key.fileobj is self._wake:
+                    self._wake.drain()
+                else:
+                    self._service(key.data, events, engine)
+            snap = engine.latest
+            if snap is not None and snap.seq != sent_seq:
+                sent_seq, frame = snap.seq, _frame(b"S", encode_snapshot(snap))
+            logs = []
+            while engine.log:
+                ts, msg, level = engine.log.popleft()
+                print(f"[{ts}] {msg}", flush=True)
+                logs.append(_frame(b"L", json.dumps([ts, msg, level]).encode()))
+            logs = b"".join(logs)
+            for c in list(self._clients.values()):
+                if c.seq != sent_seq and not c.out:
+                    c.out += frame
+                    c.seq = sent_seq
+                c.out += logs
+                if len(c.out) > CLIENT_MAX_BACKLOG:
+                    self._drop(c)
+                else:
+                    self._flush(c)
+
+    def close(self):
+        for c in list(self._clients.values()):
+            self._drop(c)
+        self._lsock.close()
+        try:
+            os.unlink(self.path)
+        except FileNotFoundError:
+            pass
+
+    def _accept(self):
+        try:
+            sock, _ = self._lsock.accept()
+        except BlockingIOError:
+            return
+        sock.setblocking(False)
+        c = self._clients[sock] = _Client(sock)
+        self._sel.register(sock, selectors.EVENT_READ, c)
+
+    def _drop(self, c):
+        self._clients.pop(c.sock, None)
+        try:
+            self._sel.unregister(c.sock)
+        except (KeyError, ValueError):
+            pass
+        c.sock.close()
+
+    def _flush(self, c):
+        if c.out:
+            try:
+                del c.out[:c.sock.send(c.out)]
+            except BlockingIOError:
+                pass
+            except OSError:
+                self._drop(c)
+                return
+        want = selectors.EVENT_READ | (selectors.EVENT_WRITE if c.out else 0)
+        if self._sel.get_key(c.sock).events != want:
+            self._sel.modify(c.sock, want, c)
+
+    def _service(self, c, events, engine):
+        if events & selectors.EVENT_WRITE:
+            self._flush(c)
+        if not events & selectors.EVENT_READ or c.sock not in self._clients:
+            return
+        try:
+            data = c.sock.recv(4096)
+        except BlockingIOError:
+            return
+        except OSError:
+            data = b""
+        if not data:
+            self._drop(c)
+            return
+        c.inbuf += data
+        while len(c.inbuf) >= _FRAME.size:
+            kind, n = _FRAME.unpack_from(c.inbuf)
+            if len(c.inbuf) < _FRAME.size + n:
+                break
+            payload = bytes(c.inbuf[_FRAME.size:_FRAME.size + n])
+            del c.inbuf[:_FRAME.size + n]
+            if kind == b"T":
+                try:
+                    engine.set_thresholds(**_json_loads(payload))
+                except (ValueError, TypeError):
+                    pass
+
+
+def _offline_snapshot(last):
+    """What a display shows once its engine is gone: last position, no traffic."""
+    return ThreatSnapshot(
+        seq=last.seq + 1, gps_ok=last.gps_ok, my_lat=last.my_lat, my_lon=last.my_lon,
+        sdr_ok=False, sdr_status="ENGINE: OFFLINE", total_ac_seen=0, table=None,
+        threats=array("l"), safe_ac=array("l"), stage_ms=(0.0, 0.0, 0.0),
+        published=time.time())
+
+
+class RemoteEngine:
+    """Display-side stand-in for ThreatEngine, fed by a SnapshotServer.
+
+    Offers the same latest / log / set_thresholds / start / stop surface,
+    so the display does not care whether detection runs in-process or in
+    a daemon.  Reconnects with backoff if the daemon goes away.
+    """
+
+    def __init__(self, path, on_publish=None):
+        self.path = path
+        self.running = False
+        self.latest = None
+        self.log = deque(maxlen=200)
+        self._on_publish = on_publish
+        self._sock = None
+        self._send_lock = threading.Lock()
+
+    def start(self):
+        self.running = True
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def stop(self):
+        self.running = False
+        sock = self._sock
+        if sock is not None:
+            try:
+                sock.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+
+    def set_thresholds(self, **changes):
+        """Apply locally for drawing, and forward anything new to the engine."""
+        changed = set_thresholds(**changes)
+        if changed:
+            with self._send_lock:
+                if self._sock is not None:
+                    try:
+                        self._sock.sendall(_frame(b"T", json.dumps(changed).encode()))
+                    except OSError:
+                        pass
+        return changed
+
+    def _run(self):
+        delay = 1.0
+        while self.running:
+            try:
+                sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+                sock.connect(self.path)
+            except OSError:
+                sock.close()
+                time.sleep(delay)
+                delay = min(delay * 2, 30.0)  # exponential backoff, cap at 30 s
+                continue
+            delay = 1.0
+            self._sock = sock
+            self.log.append((datetime.now().strftime("%H:%M:%S"),
+                             f"ENGINE: attached to {self.path}", "info"))
+            try:
+                self._read_frames(sock)
+            except OSError:
+                pass
+            with self._send_lock:
+                self._sock = None
+            sock.close()
+            if self.running:
+                self.log.append((datetime.now().strftime("%H:%M:%S"),
+                                 "ENGINE: connection lost", "danger"))
+                if self.latest is not None:
+                    self.latest = _offline_snapshot(self.latest)
+                    if self._on_publish:
+                        self._on_publish()
+
+    def _read_frames(self, sock):
+        buf = bytearray()
+        while self.running:
+            data = sock.recv(1 << 16)
+            if not data:
+                return
+            buf += data
+            pos, published = 0, False
+            while len(buf) - pos >= _FRAME.size:
+                kind, n = _FRAME.unpack_from(buf, pos)
+                if len(buf) - pos < _FRAME.size + n:
+                    break
+                payload = bytes(buf[pos + _FRAME.size:pos + _FRAME.size + n])
+                pos += _FRAME.size + n
+                if kind == b"S":
+                    self.latest = decode_snapshot(payload)
+                    published = True
+                elif kind == b"L":
+                    self.log.append(tuple(_json_loads(payload)))
+                    published = True
+            del buf[:pos]
+            if published and self._on_publish:
+                self._on_publish()
+
+
+# ── Snapshot bus ───────────────────────────────────────────────────────────────
+# A POSIX shared-memory file holding a ring of BUS_FRAMES snapshot frames.
+# Each frame is a fixed header followed by up to BUS_MAX_RECORDS fixed-size
+# aircraft records, threats first, each group nearest first.  Frame k is
+# written into ring position k % BUS_FRAMES under a seqlock: its seq field
+# reads 2k-1 while the writer is inside and 2k once the frame is complete,
+# after which the bus header's head field is set to k.  A CRC over the rest
+# of the frame lets a reader reject a torn copy even where stores can
+# become visible out of order, which Python offers no barrier against.
+_BUS_MAGIC = b"ADSB"
+_BUS_HEAD = struct.Struct("<4sIIIIQQdd")    # magic, version, frames, max records,
+                                            # record size, head, publishes,
+                                            # last / max publish ms
+_BUS_HEAD_SIZE = 64
+_BUS_SEQ = struct.Struct("<Q")
+_BUS_CRC = struct.Struct("<I")
+_BUS_FRAME = struct.Struct("<QIIIIQddd3d??32s")  # seq, crc, count, threats, total seen,
+                                                 # snapshot seq, published, my lat/lon,
+                                                 # stage ms, gps/sdr ok, sdr status
+_BUS_FRAME_SIZE = 128
+_BUS_CRC_FROM = 12                          # the CRC covers everything after itself
+_BUS_RECORD = struct.Struct("<%dd8s8s8sbb6x" % len(AircraftTable._FLOAT_COLS))
+
+
+def _bus_text(raw):
+    return raw.rstrip(b"\0").decode("ascii", "replace") or None
+
+
+class SnapshotBus:
+    """Writer side of the shared-memory snapshot bus.
+
+    publish() takes no lock and never waits on a reader — a reader that is
+    slower than the ring simply finds its frame rewritten and moves on to
+    the newest.  The writer records its own cost in the bus header so
+    readers can show it beside their lag.
+    """
+
+    def __init__(self, path, frames=BUS_FRAMES, max_records=BUS_MAX_RECORDS):
+        self.path = path
+        self.frames = frames
+        self.max_records = max_records
+        self.frame_size = _BUS_FRAME_SIZE + max_records * _BUS_RECORD.size
+        size = _BUS_HEAD_SIZE + frames * self.frame_size
+        fd = os.open(path, os.O_RDWR | os.O_CREAT | os.O_TRUNC, 0o644)
+        try:
+            os.ftruncate(fd, size)
+            self._mm = mmap.mmap(fd, size)
+        finally:
+            os.close(fd)
+        self.head = 0
+        self.publishes = 0
+        self.publish_ms = 0.0
+        self.publish_max_ms = 0.0
+        self._write_head()
+
+    def _write_head(self):
+        _BUS_HEAD.pack_into(self._mm, 0, _BUS_MAGIC, 1, self.frames, self.max_records,
+                            _BUS_RECORD.size, self.head, self.publishes,
+                            self.publish_ms, self.publish_max_ms)
+
+    def publish(self, snap):
+        t0 = time.perf_counter()
+        mm = self._mm
+        k = self.head + 1
+        off = _BUS_HEAD_SIZE + (k % self.frames) * self.frame_size
+        _BUS_SEQ.pack_into(mm, off, 2 * k - 1)
+
+        t = snap.table
+        order = [] if t is None else (list(snap.threats) + list(snap.safe_ac))[:self.max_records]
+        pos = off + _BUS_FRAME_SIZE
+        if order:
+            pack, size = _BUS_RECORD.pack_into, _BUS_RECORD.size
+            cols = [getattr(t, name) for name in AircraftTable._FLOAT_COLS]
+            for slot in order:
+                pack(mm, pos, *[c[slot] for c in cols],
+                     t.hexid[slot].encode("ascii", "replace"),
+                     (t.flight[slot] or "").encode("ascii", "replace"),
+                     (t.tail[slot] or "").encode("ascii", "replace"),
+                     t.level[slot], t.orbiting[slot])
+                pos += size
+        _BUS_FRAME.pack_into(mm, off, 2 * k - 1, 0, len(order),
+                             min(len(snap.threats), len(order)), snap.total_ac_seen,
+                             snap.seq, snap.published,
+                             _NAN if snap.my_lat is None else snap.my_lat,
+                             _NAN if snap.my_lon is None else snap.my_lon,
+                             *snap.stage_ms, snap.gps_ok, snap.sdr_ok,
+                             snap.sdr_status.encode("ascii", "replace"))
+        _BUS_CRC.pack_into(mm, off + 8, zlib.crc32(mm[off + _BUS_CRC_FROM:pos]))
+        _BUS_SEQ.pack_into(mm, off, 2 * k)
+
+        self.head = k
+        self.publishes += 1
+        self.publish_ms = (time.perf_counter() - t0) * 1000
+        self.publish_max_ms = max(self.publish_max_ms, self.publish_ms)
+        self._write_head()
+
+    def close(self):
+        self._mm.close()
+        try:
+            os.unlink(self.path)
+        except FileNotFoundError:
+            pass
+
+
+class SnapshotBusReader:
+    """Reader side of the snapshot bus; any number may map the same file.
+
+    poll() returns the newest complete frame as a ThreatSnapshot whose
+    table slots are record numbers, or None if nothing new has been
+    published.  Counters: frames_read, frames_skipped (published but never
+    seen because a newer one was already there), retries (copies rejected
+    as torn because the seq moved), crc_rejects (copies whose seq checked
+    out but whose CRC did not), lag_ms (publish to read of the last frame)
+    and the writer's own publish_ms / publish_max_ms from the bus header.
+    `inode` identifies the file mapped, which a restarted writer replaces.
+    """
+
+    def __init__(self, path):
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            self.inode = os.fstat(fd).st_ino
+            self._mm = mmap.mmap(fd, 0, access=mmap.ACCESS_READ)
+        finally:
+            os.close(fd)
+        magic, version, self.frames, self.max_records, rec_size, *_ = \
+            _BUS_HEAD.unpack_from(self._mm, 0)
+        if magic != _BUS_MAGIC or version != 1 or rec_size != _BUS_RECORD.size:
+            self._mm.close()
+            raise ValueError(f"{path}: not a compatible snapshot bus")
+        self.frame_size = _BUS_FRAME_SIZE + self.max_records * _BUS_RECORD.size
+        self.seen = 0
+        self.frames_read = 0
+        self.frames_skipped = 0
+        self.retries = 0
+        self.crc_rejects = 0
+        self.lag_ms = None
+        self.publish_ms = self.publish_max_ms = 0.0
+
+    def close(self):
+        self._mm.close()
+
+    def poll(self):
+        mm = self._mm
+        for _ in range(8):
+            head = _BUS_HEAD.unpack_from(mm, 0)
+            k = head[5]
+            if k == self.seen:
+                return None
+            off = _BUS_HEAD_SIZE + (k % self.frames) * self.frame_size
+            if _BUS_SEQ.unpack_from(mm, off)[0] != 2 * k:
+                self.retries += 1       # lapped — the writer is already reusing it
+                continue
+            count = min(_BUS_FRAME.unpack_from(mm, off)[2], self.max_records)
+            frame = mm[off:off + _BUS_FRAME_SIZE + count * _BUS_RECORD.size]
+            fields = _BUS_FRAME.unpack_from(frame)
+            if (_BUS_SEQ.unpack_from(mm, off)[0] != 2 * k or fields[0] != 2 * k
+                    or fields[2] != count):
+                self.retries += 1
+                continue
+            if zlib.crc32(frame[_BUS_CRC_FROM:]) != fields[1]:
+                self.crc_rejects += 1
+                continue
+            if self.seen:
+                self.frames_skipped += max(k - self.seen - 1, 0)
+            self.seen = k
+            self.frames_read += 1
+            self.publish_ms, self.publish_max_ms = head[7], head[8]
+            return self._decode(fields, frame)
+        return None
+
+    def _decode(self, fields, frame):
+        (_, _, count, n_threats, total, seq, published, my_lat, my_lon,
+         s0, s1, s2, gps_ok, sdr_ok, status) = fields
+        names = AircraftTable._FLOAT_COLS
+        rows = list(_BUS_RECORD.iter_unpack(frame[_BUS_FRAME_SIZE:])) if count else []
+        cols = list(zip(*rows)) if rows else [()] * (len(names) + 5)
+        t = AircraftTable.__new__(AircraftTable)
+        t._free = []
+        for n, name in enumerate(names):
+            setattr(t, name, array("d", cols[n]))
+        t.hexid = [_bus_text(h) for h in cols[len(names)]]
+        t.flight = [_bus_text(f) for f in cols[len(names) + 1]]
+        t.tail = [_bus_text(f) for f in cols[len(names) + 2]]
+        t.level = array("b", cols[len(names) + 3])
+        t.orbiting = array("b", cols[len(names) + 4])
+        t.slot_of = {h: slot for slot, h in enumerate(t.hexid)}
+        self.lag_ms = (time.time() - published) * 1000
+        return ThreatSnapshot(
+            seq=seq, gps_ok=gps_ok, my_lat=None if my_lat != my_lat else my_lat,
+            my_lon=None if my_lon != my_lon else my_lon, sdr_ok=sdr_ok,
+            sdr_status=_bus_text(status) or "", total_ac_seen=total, table=t,
+            threats=array("l", range(n_threats)),
+            safe_ac=array("l", range(n_threats, count)),
+            stage_ms=(s0, s1, s2), published=published)
+
+
+class BusEngine:
+    """Read-only display-side stand-in for ThreatEngine over a SnapshotBus.
+
+    Polls the bus every BUS_POLL_SEC.  The bus carries snapshots only: the
+    alert log holds just this reader's own status lines, and threshold
+    edits change the local drawing but never reach the engine.
+
+    A daemon that exits unlinks the bus and a restarted one creates a new
+    file in its place, so the mapping held here would never change again.
+    When the path names a different inode, or no new frame has been
+    published for BUS_STALE_SEC, the display is shown ENGINE: OFFLINE as
+    RemoteEngine does on disconnect, and the bus is reopened.
+    """
+
+    def __init__(self, path, on_publish=None):
+        self.path = path
+        self.running = False
+        self.latest = None
+        self.reader = None
+        self.log = deque(maxlen=200)
+        self._on_publish = on_publish
+        self._heard = 0.0               # monotonic time of the newest publish seen
+        self._offline = False
+
+    def start(self):
+        self.running = True
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def stop(self):
+        self.running = False
+
+    def set_thresholds(self, **changes):
+        return set_thresholds(**changes)
+
+    def _emit(self, msg, level):
+        self.log.append((datetime.now().strftime("%H:%M:%S"), msg, level))
+
+    def _open(self, old):
+        """Map the bus; reopening the same file resumes past what was read."""
+        reader = SnapshotBusReader(self.path)
+        if old is not None and reader.inode == old.inode:
+            reader.seen = old.seen
+        else:
+            self._emit(f"BUS: reading {self.path}", "info")
+            self._heard = time.monotonic()
+        return reader
+
+    def _gone(self, reader):
+        if time.monotonic() - self._heard > BUS_STALE_SEC:
+            return True
+        try:
+            return os.stat(self.path).st_ino != reader.inode
+        except OSError:
+            return True
+
+    def _run(self):
+        old = None
+        while self.running:
+            if self.reader is None:
+                try:
+                    self.reader = self._open(old)
+                except (OSError, ValueError):
+                    time.sleep(1.0)
+                    continue
+            snap = self.reader.poll()
+            if snap is not None:
+                # Age from the writer's publish time, so a bus left behind by
+                # a dead engine reads as stale from the start.
+                self._heard = time.monotonic() - max(time.time() - snap.published, 0.0)
+                self._offline = False
+                self.latest = snap
+                if self._on_publish:
+                    self._on_publish()
+            elif self._gone(self.reader):
+                # The old mapping keeps its inode alive, so a new bus file
+                # can never reuse the number while we compare against it.
+                old, self.reader = self.reader, None
+                old.close()
+                if not self._offline and self.latest is not None:
+                    self._offline = True
+                    self._emit("ENGINE: bus stopped publishing", "danger")
+                    self.latest = _offline_snapshot(self.latest)
+                    if self._on_publish:
+                        self._on_publish()
+                time.sleep(1.0)
+                continue
+            time.sleep(BUS_POLL_SEC)
+
+
+def run_daemon(path, bus_path=None):
+    """Detect and alert without a display, serving snapshots on path and,
+    if bus_path is given, on a shared-memory snapshot bus as well."""
+    server = SnapshotServer(path)
+    bus = SnapshotBus(bus_path) if bus_path else None
+
+    def on_publish():
+        if bus is not None:
+            bus.publish(engine.latest)
+        server.publish()
+
+    engine = ThreatEngine(on_publish=on_publish)
+    signal.signal(signal.SIGTERM, lambda *_: engine.stop())
+    engine.start()
+    try:
+        server.serve(engine)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        engine.stop()
+        server.close()
+        if bus is not None:
+            bus.close()
+
+
+# ── Command line ───────────────────────────────────────────────────────────────
+def add_engine_args(parser):
+    parser.add_argument("--ingest", choices=["json", "sbs"], default=INGEST_MODE,
+                        help="poll aircraft.json or stream readsb SBS output")
+    parser.add_argument("--sbs", default=f"{SBS_HOST}:{SBS_PORT}",
+                        metavar="HOST:PORT", help="readsb SBS endpoint")
+    parser.add_argument("--gps", choices=["gpsd", "serial"], default=GPS_SOURCE,
+                        help="read own-ship position from gpsd, or straight "
+                             "from the receiver's serial port")
+    parser.add_argument("--gps-device", default=GPS_DEVICE, metavar="PATH",
+                        help="serial port for --gps serial")
+    parser.add_argument("--gps-baud", type=int, default=GPS_BAUD, metavar="BAUD")
+    parser.add_argument("--ubx", action="store_true", default=GPS_UBX,
+                        help="also enable and decode u-blox NAV-PVT on the port")
+    parser.add_argument("--audio-sink", default=AUDIO_SINK, metavar="SINK",
+                        help='"player" (pacat/aplay), "null", or a file to '
+                             "append raw 22.05 kHz s16le audio to")
+
+
+def apply_engine_args(args):
+    global INGEST_MODE, SBS_HOST, SBS_PORT, AUDIO_SINK
+    global GPS_SOURCE, GPS_DEVICE, GPS_BAUD, GPS_UBX
+    INGEST_MODE = args.ingest
+    SBS_HOST, _, port = args.sbs.rpartition(":")
+    SBS_PORT = int(port)
+    AUDIO_SINK = args.audio_sink
+    GPS_SOURCE, GPS_DEVICE = args.gps, args.gps_device
+    GPS_BAUD, GPS_UBX = args.gps_baud, args.ubx
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="ADS-B alert engine (headless)")
+    add_engine_args(parser)
+    parser.add_argument("--socket", default=ENGINE_SOCKET, metavar="PATH",
+                        help="Unix socket to serve display clients on")
+    parser.add_argument("--shm", nargs="?", const=SHM_BUS_PATH, metavar="PATH",
+                        help="also publish snapshots on a shared-memory bus")
+    parser.add_argument("--observers", metavar="FILE",
+                        help="evaluate the sites in this JSON file instead of "
+                             "own-ship GPS")
+    args = parser.parse_args()
+    apply_engine_args(args)
+    if args.observers:
+        run_fleet(load_observers(args.observers))
+    else:
+        run_daemon(args.socket, args.shm)
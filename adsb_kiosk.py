@@ -0,0 +1,355 @@
+#!/usr/bin/env python3
+"""
+ADS-B kiosk display – banner, radar, threat cards and alert log drawn
+straight into a Linux framebuffer, with no X server or Tk.
+
+For cockpit and field units that only ever show the scope.  Detection
+runs in-process, or this attaches to a headless adsb_engine daemon just
+as adsb_alert.py does.  --fb may also name a plain file (with --size),
+which is written as a raw framebuffer image.  Needs numpy.
+"""
+import os, time, mmap, fcntl, ctypes, signal, argparse, selectors
+from datetime import datetime
+from collections import deque
+
+import adsb_engine
+from adsb_engine import (np, SAMPLE_SEC, ENGINE_SOCKET, SHM_BUS_PATH, PREDICT_FRAME_SEC,
+                         ThreatEngine, RemoteEngine, BusEngine, _Waker, predict_positions)
+from adsb_render import (C, FONT_W, FONT_H, SWEEP_DEG_PER_SEC, RadarRaster, text_pixels,
+                         banner_state, card_aircraft, card_lines, process_stats, _rgb)
+
+FB_DEVICE = "/dev/fb0"
+KIOSK_LOG_LINES = 200
+
+# ── Framebuffer ────────────────────────────────────────────────────────────────
+FBIOGET_VSCREENINFO = 0x4600
+FBIOGET_FSCREENINFO = 0x4602
+
+
+class _FbBitfield(ctypes.Structure):
+    _fields_ = [("offset", ctypes.c_uint32), ("length", ctypes.c_uint32),
+                ("msb_right", ctypes.c_uint32)]
+
+
+class _FbVarScreeninfo(ctypes.Structure):
+    _fields_ = [("xres", ctypes.c_uint32), ("yres", ctypes.c_uint32),
+                ("xres_virtual", ctypes.c_uint32), ("yres_virtual", ctypes.c_uint32),
+                ("xoffset", ctypes.c_uint32), ("yoffset", ctypes.c_uint32),
+                ("bits_per_pixel", ctypes.c_uint32), ("grayscale", ctypes.c_uint32),
+                ("red", _FbBitfield), ("green", _FbBitfield),
+                ("blue", _FbBitfield), ("transp", _FbBitfield),
+                ("nonstd", ctypes.c_uint32), ("activate", ctypes.c_uint32),
+                ("height", ctypes.c_uint32), ("width", ctypes.c_uint32),
+                ("accel_flags", ctypes.c_uint32), ("pixclock", ctypes.c_uint32),
+                ("left_margin", ctypes.c_uint32), ("right_margin", ctypes.c_uint32),
+                ("upper_margin", ctypes.c_uint32), ("lower_margin", ctypes.c_uint32),
+                ("hsync_len", ctypes.c_uint32), ("vsync_len", ctypes.c_uint32),
+                ("sync", ctypes.c_uint32), ("vmode", ctypes.c_uint32),
+                ("rotate", ctypes.c_uint32), ("colorspace", ctypes.c_uint32),
+                ("reserved", ctypes.c_uint32 * 4)]
+
+
+class _FbFixScreeninfo(ctypes.Structure):
+    _fields_ = [("id", ctypes.c_char * 16), ("smem_start", ctypes.c_ulong),
+                ("smem_len", ctypes.c_uint32), ("type", ctypes.c_uint32),
+                ("type_aux", ctypes.c_uint32), ("visual", ctypes.c_uint32),
+                ("xpanstep", ctypes.c_uint16), ("ypanstep", ctypes.c_uint16),
+                ("ywrapstep", ctypes.c_uint16), ("line_length", ctypes.c_uint32),
+                ("mmio_start", ctypes.c_ulong), ("mmio_len", ctypes.c_uint32),
+                ("accel", ctypes.c_uint32), ("capabilities", ctypes.c_uint16),
+                ("reserved", ctypes.c_uint16 * 2)]
+
+
+class Framebuffer:
+    """The front buffer: a framebuffer device, or a raw image file in its place.
+
+    A device reports its own geometry and pixel format; a file needs `size`
+    and `bpp` and is created to fit.  A device's whole virtual screen is
+    mapped and drawing goes to the page on show at (xoffset, yoffset), so a
+    double-buffered or panned console is drawn where it is visible.  32 bpp
+    is stored as B, G, R, X bytes unless the device puts red lowest; 16 bpp
+    is RGB565.  blit() converts boxes of an RGB back buffer into that format
+    in place.
+    """
+
+    def __init__(self, path, size=None, bpp=32):
+        self.path = path
+        self._fd = os.open(path, os.O_RDWR | (os.O_CREAT if size else 0), 0o644)
+        red_offset = 16
+        x_off = y_off = 0
+        if size is None:
+            var, fix = _FbVarScreeninfo(), _FbFixScreeninfo()
+            fcntl.ioctl(self._fd, FBIOGET_VSCREENINFO, var)
+            fcntl.ioctl(self._fd, FBIOGET_FSCREENINFO, fix)
+            self.width, self.height = var.xres, var.yres
+            bpp, self.stride, red_offset = var.bits_per_pixel, fix.line_length, var.red.offset
+            x_off, y_off = var.xoffset, var.yoffset
+            rows = max(var.yres_virtual, y_off + self.height)
+        else:
+            self.width, self.height = size
+            self.stride = self.width * bpp // 8
+            rows = self.height
+            os.ftruncate(self._fd, self.stride * rows)
+        if bpp not in (16, 32):
+            os.close(self._fd)
+            raise ValueError(f"{path}: {bpp} bpp framebuffers are not supported")
+        self.bpp = bpp
+        self._rgb_at = (0, 1, 2) if red_offset == 0 else (2, 1, 0)
+        self._mm = mmap.mmap(self._fd, self.stride * rows)
+        screen = np.frombuffer(self._mm, dtype=np.uint8).reshape(rows, self.stride)
+        x0 = x_off * bpp // 8
+        self._front = screen[y_off:y_off + self.height, x0:x0 + self.width * bpp // 8]
+
+    def blit(self, rgb, boxes):
+        for x0, y0, x1, y1 in boxes:
+            src = rgb[y0:y1, x0:x1]
+            if self.bpp == 32:
+                dst = self._front[y0:y1, x0 * 4:x1 * 4].reshape(y1 - y0, x1 - x0, 4)
+                r, g, b = self._rgb_at
+                dst[..., r] = src[..., 0]
+                dst[..., g] = src[..., 1]
+                dst[..., b] = src[..., 2]
+                dst[..., 3] = 255
+            else:
+                dst = self._front[y0:y1, x0 * 2:x1 * 2].view(np.uint16)
+                px = src.astype(np.uint16)
+                dst[:] = (px[..., 0] >> 3 << 11) | (px[..., 1] >> 2 << 5) | (px[..., 2] >> 3)
+
+    def close(self):
+        self._front = None
+        self._mm.close()
+        os.close(self._fd)
+
+
+# ── Kiosk display ──────────────────────────────────────────────────────────────
+class KioskDisplay:
+    """The Tk display's layout, drawn with numpy into an RGB back buffer.
+
+    Every panel is redrawn only when its text changes, and the radar only
+    where the sweep or a dead-reckoned aircraft moved; each changed box is
+    queued and flush() copies just those boxes to the framebuffer, so a
+    quiet screen costs one sweep wedge per frame.
+    """
+    BANNER = {"clear":   ("green",  "panel",   "AIRSPACE CLEAR"),
+              "caution": ("yellow", "#1a1600", "CAUTION: "),
+              "warning": ("orange", "#1a0a00", "WARNING: "),
+              "danger":  ("#ffffff", "#3a0000", "DANGER:  "),
+              "orbit":   ("cyan",   "#001a1a", "ORBIT:   ")}
+
+    def __init__(self, fb, attach=None, bus=None):
+        self.fb = fb
+        W, H = fb.width, fb.height
+        self.back = np.zeros((H, W, 3), dtype=np.uint8)
+        self.back[:] = _rgb(C["bg"])
+        self.s = s = max(1, min(W // 400, H // 240))    # HiDPI factor
+        self.line_h = (FONT_H + 4) * s
+        self.banner_box = (0, 0, W, 2 * self.line_h)
+        self.status_box = (0, H - self.line_h - 2 * s, W, H)
+        body_top, body_bottom = self.banner_box[3] + 2 * s, self.status_box[1] - 2 * s
+        side = max(min(body_bottom - body_top, W // 2), 16)
+        self.radar_at = (2 * s, body_top)
+        self.right_box = (side + 6 * s, body_top, W - 2 * s, body_bottom)
+        self.raster = RadarRaster(side, side, s)
+        self._dirty = [(0, 0, W, H)]
+        self._shown = {}                # panel -> what it was last drawn with
+        self.log = deque(maxlen=KIOSK_LOG_LINES)
+        self.running = False
+        self._sweep_angle = 0
+        self._sweep_step = SWEEP_DEG_PER_SEC * PREDICT_FRAME_SEC
+        self._table, self._slots = None, []
+        self._snap = None
+        self._first_frame = False
+        self._waker = _Waker()
+        if bus:
+            self.engine = BusEngine(bus, on_publish=self._waker.wake)
+        elif attach:
+            self.engine = RemoteEngine(attach, on_publish=self._waker.wake)
+        else:
+            self.engine = ThreatEngine(on_publish=self._waker.wake)
+
+    # ── Drawing primitives ─────────────────────────────────────────────────────
+    def _fill(self, box, color):
+        x0, y0, x1, y1 = box
+        self.back[y0:y1, x0:x1] = _rgb(C.get(color, color))
+
+    def _text(self, x, y, text, color, scale, clip):
+        rows, cols = text_pixels(text, scale)
+        rows, cols = rows + y, cols + x
+        x0, y0, x1, y1 = clip
+        ok = (rows >= y0) & (rows < y1) & (cols >= x0) & (cols < x1)
+        self.back[rows[ok], cols[ok]] = _rgb(C.get(color, color))
+
+    def _panel(self, name, box, content, draw):
+        """Redraw box with draw() if content differs from last time."""
+        if self._shown.get(name) == content:
+            return
+        self._shown[name] = content
+        draw()
+        self._dirty.append(box)
+
+    # ── Panels ─────────────────────────────────────────────────────────────────
+    def _draw_banner(self, kind, msg):
+        fg, bg, prefix = self.BANNER[kind]
+        text = f"  {prefix}{msg}"
+        box = self.banner_box
+        width = box[2] - box[0]
+        scale = 2 * self.s if len(text) * FONT_W * 2 * self.s <= width else self.s
+        def draw():
+            self._fill(box, bg)
+            self._text(box[0], (box[1] + box[3] - FONT_H * scale) // 2, text, fg, scale, box)
+        self._panel("banner", box, (kind, msg), draw)
+
+    def _draw_right(self, cards, log):
+        s, lh = self.s, self.line_h
+        x0, y0, x1, y1 = self.right_box
+        cards_box = (x0, y0, x1, y0 + lh * 7)
+        def draw_cards():
+            self._fill(cards_box, "bg")
+            self._text(x0, y0, "ACTIVE THREATS", "text_dim", s, cards_box)
+            for n in range(2):
+                top = y0 + lh * (1 + 3 * n)
+                self._fill((x0, top, x1, top + s), "border_bright")
+                self._fill((x0, top + s, x1, top + 3 * lh - s), "panel")
+                if n < len(cards):
+                    line1, line2, color = cards[n]
+                    self._text(x0 + 3 * s, top + lh // 2, line1, color, s, cards_box)
+                    self._text(x0 + 3 * s, top + lh // 2 + lh, line2, "text_dim", s, cards_box)
+        self._panel("cards", cards_box, cards, draw_cards)
+
+        log_box = (x0, cards_box[3], x1, y1)
+        rows = max((y1 - log_box[1]) // lh - 1, 0)
+        tail = tuple(list(log)[-rows:]) if rows else ()
+        def draw_log():
+            self._fill(log_box, "bg")
+            self._text(x0, log_box[1], "ALERT LOG", "text_dim", s, log_box)
+            self._fill((x0, log_box[1] + lh, x1, y1), "panel")
+            for n, (ts, msg, level) in enumerate(tail):
+                color = {"caution": "yellow", "warning": "orange", "danger": "red",
+                         "orbit": "cyan", "safe": "blue"}.get(level, "text_dim")
+                self._text(x0 + 2 * s, log_box[1] + lh * (n + 1) + 2 * s,
+                           f"[{ts}] {msg}", color, s, log_box)
+        self._panel("log", log_box, tail, draw_log)
+
+    def _draw_status(self, gps, sdr, ac, clock):
+        box, s = self.status_box, self.s
+        def draw():
+            self._fill(box, "panel")
+            y = box[1] + 2 * s
+            x = 4 * s
+            for text, color in (gps, sdr, ac):
+                self._text(x, y, text, color, s, box)
+                x += (len(text) + 3) * FONT_W * s
+            self._text(box[2] - (len(clock) + 2) * FONT_W * s, y, clock, "text_dim", s, box)
+        self._panel("status", box, (gps, sdr, ac, clock), draw)
+
+    # ── Snapshots ──────────────────────────────────────────────────────────────
+    def _render(self, snap):
+        while self.engine.log:
+            self.log.append(self.engine.log.popleft())
+        clock = datetime.now().strftime("%H:%M:%S")
+        table, threats, safe_ac = None, (), ()
+        if snap is None or not snap.gps_ok:
+            self._draw_banner("caution", "AWAITING GPS FIX")
+            status = (("GPS: ACQUIRING...", "yellow"), ("SDR: --", "text_dim"), ("AC: 0", "text_dim"))
+        elif not snap.sdr_ok:
+            self._draw_banner("caution", snap.sdr_status)
+            status = (("GPS: LOCKED", "green"), (snap.sdr_status, "red"), ("AC: 0", "text_dim"))
+        else:
+            table, threats, safe_ac = snap.table, snap.threats, snap.safe_ac
+            self._draw_banner(*banner_state(table, threats, safe_ac))
+            status = (("GPS: LOCKED", "green"), (snap.sdr_status, "green"),
+                      (f"AC: {snap.total_ac_seen}",
+                       "cyan" if snap.total_ac_seen > 0 else "text_dim"))
+        self._draw_status(*status, clock)
+        cards = tuple(card_lines(ac) for ac in card_aircraft(table, threats, safe_ac)) if table else ()
+        self._draw_right(cards, self.log)
+        if snap is not self._snap:
+            self._snap = snap
+            self._table, self._slots = table, list(safe_ac) + list(threats)
+            if table is None:
+                self.raster.clear_targets()
+            else:
+                self.raster.set_table(table, self._slots, None, adsb_engine.RING_CAUTION_MI,
+                                      *predict_positions(table, self._slots, time.time()))
+
+    def _frame(self):
+        raster = self.raster
+        if self._slots:
+            raster.move(*predict_positions(self._table, self._slots, time.time()),
+                        adsb_engine.RING_CAUTION_MI)
+        raster.render(self._sweep_angle)
+        self._sweep_angle = (self._sweep_angle + self._sweep_step) % 360
+        x0, y0, x1, y1 = raster.dirty
+        ox, oy = self.radar_at
+        self.back[oy + y0:oy + y1, ox + x0:ox + x1] = raster.rgb[y0:y1, x0:x1]
+        self._dirty.append((ox + x0, oy + y0, ox + x1, oy + y1))
+        self.flush()
+
+    def flush(self):
+        full = (0, 0, self.fb.width, self.fb.height)
+        self.fb.blit(self.back, [full] if full in self._dirty else self._dirty)
+        self._dirty = []
+        if not self._first_frame:
+            self._first_frame = True
+            age, rss = process_stats()
+            if age is not None:
+                print(f"kiosk: first frame {age:.2f}s after start, RSS {rss:.0f} MB", flush=True)
+
+    # ── Main loop ──────────────────────────────────────────────────────────────
+    def run(self, frame_sec=PREDICT_FRAME_SEC):
+        """Draw until stop(): snapshots as they arrive, the sweep every frame_sec."""
+        self.running = True
+        self._sweep_step = SWEEP_DEG_PER_SEC * frame_sec
+        self.engine.start()
+        self._render(None)
+        sel = selectors.DefaultSelector()
+        sel.register(self._waker.fileno(), selectors.EVENT_READ)
+        next_frame = next_tick = time.monotonic()
+        try:
+            while self.running:
+                now = time.monotonic()
+                if sel.select(max(0.0, min(next_frame, next_tick) - now)):
+                    self._waker.drain()
+                    self._render(self.engine.latest)
+                now = time.monotonic()
+                if now >= next_tick:                # clock and log, as the Tk tick
+                    self._render(self.engine.latest)
+                    next_tick = now + SAMPLE_SEC
+                if now >= next_frame:
+                    self._frame()
+                    next_frame = max(next_frame + frame_sec, now)
+        finally:
+            sel.close()
+            self.engine.stop()
+
+    def stop(self):
+        self.running = False
+
+
+# ── Entry point ────────────────────────────────────────────────────────────────
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="ADS-B framebuffer kiosk display")
+    adsb_engine.add_engine_args(parser)
+    parser.add_argument("--fb", default=FB_DEVICE, metavar="PATH",
+                        help="framebuffer device, or an image file with --size")
+    parser.add_argument("--size", metavar="WxH",
+                        help="treat --fb as a raw image file of this size")
+    parser.add_argument("--bpp", type=int, choices=[16, 32], default=32,
+                        help="pixel format of a --size image file")
+    parser.add_argument("--attach", nargs="?", const=ENGINE_SOCKET, metavar="SOCKET",
+                        help="display a running adsb_engine daemon instead of "
+                             "detecting in-process")
+    parser.add_argument("--bus", nargs="?", const=SHM_BUS_PATH, metavar="PATH",
+                        help="display a daemon's shared-memory bus, read-only")
+    args = parser.parse_args()
+    adsb_engine.apply_engine_args(args)
+
+    size = tuple(int(v) for v in args.size.lower().split("x")) if args.size else None
+    kiosk = KioskDisplay(Framebuffer(args.fb, size, args.bpp), attach=args.attach, bus=args.bus)
+    signal.signal(signal.SIGTERM, lambda *_: kiosk.stop())
+    try:
+        kiosk.run()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        kiosk.fb.close()
@@ -0,0 +1,529 @@
+#!/usr/bin/env python3
+"""
+ADS-B radar rasterizer – the whole scope drawn into one RGBA buffer.
+
+Imports no GUI toolkit.  The Tk display blits the buffer as a single
+PhotoImage each frame instead of keeping canvas items per ring, sweep
+segment and aircraft.  Needs numpy; without it the display keeps its
+canvas radar.  Run directly for a frame-time benchmark.
+"""
+import os, math, time, argparse
+
+import adsb_engine
+from adsb_engine import np, RING_WARN_MI, RING_DANGER_MI, Aircraft, bearing_to_compass
+
+RASTER_OK = np is not None
+SWEEP_DEG_PER_SEC = 37.5                # one turn of the sweep in 9.6 s
+
+# ── Colour palette ─────────────────────────────────────────────────────────────
+C = {
+    "bg":            "#0a0f0a",
+    "panel":         "#0d150d",
+    "border":        "#1a2a1a",
+    "border_bright": "#2a4a2a",
+    "text":          "#c8e6c8",
+    "text_dim":      "#5a8a5a",
+    "green":         "#00ff41",
+    "green_radar":   "#00c830",
+    "yellow":        "#ffd700",
+    "orange":        "#ff8c00",
+    "red":           "#ff2020",
+    "cyan":          "#00e5ff",
+    "blue":          "#4488ff",
+}
+
+
+def _rgb(color):
+    return int(color[1:3], 16), int(color[3:5], 16), int(color[5:7], 16)
+
+
+# ── Presentation ───────────────────────────────────────────────────────────────
+# What the banner and threat cards say, shared by every display backend.
+def orbiting_safe(table, safe_ac, limit):
+    return [Aircraft(table, s) for s in safe_ac if table.orbiting[s]][:limit]
+
+
+def banner_state(table, threats, safe_ac):
+    """("danger" | "warning" | "caution" | "orbit" | "clear", message)."""
+    if threats:
+        w = Aircraft(table, threats[0])
+        msg = f"{w.ident}  {w.dist_mi:.2f}mi  {w.alt_ft}ft  {w.eta_str}"
+        return ("caution", "warning", "danger")[min(w.threat_level, 2)], msg
+    orbiting = orbiting_safe(table, safe_ac, 1)
+    if orbiting:
+        o = orbiting[0]
+        return "orbit", f"{o.ident}  {o.dist_mi:.2f}mi  {bearing_to_compass(o.bearing_from_me)}"
+    return "clear", ""
+
+
+def card_aircraft(table, threats, safe_ac, n=2):
+    """Aircraft for the threat cards: nearest threats, then orbiting traffic."""
+    shown = [Aircraft(table, s) for s in threats[:n]]
+    if len(shown) < n:
+        shown += orbiting_safe(table, safe_ac, n - len(shown))
+    return shown
+
+
+def card_lines(ac):
+    """(line 1, line 2, palette key) for one threat card."""
+    color = ("yellow", "orange", "red")[min(ac.threat_level, 2)] if ac.threat_level else "cyan"
+    return (f"{ac.ident:<12}  {ac.dist_mi:.2f} mi  {ac.alt_ft} ft",
+            f"  {ac.eta_str}  {ac.closing_str}  {'ORBIT' if ac.is_orbiting else ''}",
+            color)
+
+
+def process_stats():
+    """(seconds since this process started, resident MB), from Linux /proc.
+
+    Lets each display report boot-to-first-frame and memory the same way;
+    (None, None) where /proc is not available.
+    """
+    try:
+        with open("/proc/self/stat") as f:
+            start_ticks = int(f.read().rpartition(")")[2].split()[19])
+        with open("/proc/uptime") as f:
+            uptime = float(f.read().split()[0])
+        with open("/proc/self/statm") as f:
+            rss_pages = int(f.read().split()[1])
+    except (OSError, ValueError, IndexError):
+        return None, None
+    age = uptime - start_ticks / os.sysconf("SC_CLK_TCK")
+    return age, rss_pages * os.sysconf("SC_PAGE_SIZE") / (1 << 20)
+
+
+# ── Baked font ─────────────────────────────────────────────────────────────────
+# 5×7 glyphs, one byte per column, bit 0 at the top.  Covers what the
+# displays print, in capitals.
+_FONT = {
+    " ": (0x00, 0x00, 0x00, 0x00, 0x00), "+": (0x08, 0x08, 0x3E, 0x08, 0x08),
+    "-": (0x08, 0x08, 0x08, 0x08, 0x08), ".": (0x00, 0x60, 0x60, 0x00, 0x00),
+    "?": (0x02, 0x01, 0x51, 0x09, 0x06), ":": (0x00, 0x36, 0x36, 0x00, 0x00),
+    ",": (0x00, 0x50, 0x30, 0x00, 0x00), "'": (0x00, 0x05, 0x03, 0x00, 0x00),
+    "/": (0x20, 0x10, 0x08, 0x04, 0x02), "%": (0x23, 0x13, 0x08, 0x64, 0x62),
+    "(": (0x00, 0x1C, 0x22, 0x41, 0x00), ")": (0x00, 0x41, 0x22, 0x1C, 0x00),
+    "[": (0x00, 0x7F, 0x41, 0x41, 0x00), "]": (0x00, 0x41, 0x41, 0x7F, 0x00),
+    "#": (0x14, 0x7F, 0x14, 0x7F, 0x14), "=": (0x14, 0x14, 0x14, 0x14, 0x14),
+    "!": (0x00, 0x00, 0x5F, 0x00, 0x00), "°": (0x00, 0x06, 0x09, 0x09, 0x06),
+    "±": (0x44, 0x44, 0x5F, 0x44, 0x44),
+    "0": (0x3E, 0x51, 0x49, 0x45, 0x3E), "1": (0x00, 0x42, 0x7F, 0x40, 0x00),
+    "2": (0x42, 0x61, 0x51, 0x49, 0x46), "3": (0x21, 0x41, 0x45, 0x4B, 0x31),
+    "4": (0x18, 0x14, 0x12, 0x7F, 0x10), "5": (0x27, 0x45, 0x45, 0x45, 0x39),
+    "6": (0x3C, 0x4A, 0x49, 0x49, 0x30), "7": (0x01, 0x71, 0x09, 0x05, 0x03),
+    "8": (0x36, 0x49, 0x49, 0x49, 0x36), "9": (0x06, 0x49, 0x49, 0x29, 0x1E),
+    "A": (0x7E, 0x11, 0x11, 0x11, 0x7E), "B": (0x7F, 0x49, 0x49, 0x49, 0x36),
+    "C": (0x3E, 0x41, 0x41, 0x41, 0x22), "D": (0x7F, 0x41, 0x41, 0x22, 0x1C),
+    "E": (0x7F, 0x49, 0x49, 0x49, 0x41), "F": (0x7F, 0x09, 0x09, 0x09, 0x01),
+    "G": (0x3E, 0x41, 0x49, 0x49, 0x7A), "H": (0x7F, 0x08, 0x08, 0x08, 0x7F),
+    "I": (0x00, 0x41, 0x7F, 0x41, 0x00), "J": (0x20, 0x40, 0x41, 0x3F, 0x01),
+    "K": (0x7F, 0x08, 0x14, 0x22, 0x41), "L": (0x7F, 0x40, 0x40, 0x40, 0x40),
+    "M": (0x7F, 0x02, 0x0C, 0x02, 0x7F), "N": (0x7F, 0x04, 0x08, 0x10, 0x7F),
+    "O": (0x3E, 0x41, 0x41, 0x41, 0x3E), "P": (0x7F, 0x09, 0x09, 0x09, 0x06),
+    "Q": (0x3E, 0x41, 0x51, 0x21, 0x5E), "R": (0x7F, 0x09, 0x19, 0x29, 0x46),
+    "S": (0x46, 0x49, 0x49, 0x49, 0x31), "T": (0x01, 0x01, 0x7F, 0x01, 0x01),
+    "U": (0x3F, 0x40, 0x40, 0x40, 0x3F), "V": (0x1F, 0x20, 0x40, 0x20, 0x1F),
+    "W": (0x3F, 0x40, 0x38, 0x40, 0x3F), "X": (0x63, 0x14, 0x08, 0x14, 0x63),
+    "Y": (0x07, 0x08, 0x70, 0x08, 0x07), "Z": (0x61, 0x51, 0x49, 0x45, 0x43),
+}
+FONT_W, FONT_H = 6, 7                   # advance and height in font pixels
+
+
+_glyph_cache = {}
+
+
+def _glyph_pixels(ch, scale):
+    key = (ch, scale)
+    px = _glyph_cache.get(key)
+    if px is None:
+        glyph = _FONT.get(ch.upper(), _FONT["?"])
+        rows = [gy for gx, bits in enumerate(glyph) for gy in range(FONT_H) if bits >> gy & 1]
+        cols = [gx for gx, bits in enumerate(glyph) for gy in range(FONT_H) if bits >> gy & 1]
+        y, x = np.array(rows, dtype=np.intp), np.array(cols, dtype=np.intp)
+        if scale > 1:
+            sy, sx = np.divmod(np.arange(scale * scale), scale)
+            y = (y[:, None] * scale + sy).ravel()
+            x = (x[:, None] * scale + sx).ravel()
+        px = _glyph_cache[key] = (y, x)
+    return px
+
+
+def text_pixels(text, scale=1):
+    """(rows, cols) of the lit pixels of text, each font pixel scale×scale."""
+    if not text:
+        return np.zeros(0, dtype=np.intp), np.zeros(0, dtype=np.intp)
+    glyphs = [_glyph_pixels(ch, scale) for ch in text]
+    rows = np.concatenate([g[0] for g in glyphs])
+    cols = np.concatenate([g[1] + n * FONT_W * scale for n, g in enumerate(glyphs)])
+    return rows, cols
+
+
+# ── Rasterizer ─────────────────────────────────────────────────────────────────
+def _packed(px):
+    """(n, 3) uint8 pixels as n 3-byte items, which numpy gathers and scatters far faster."""
+    return px.view("V3").reshape(-1)
+
+
+def _unpacked(items):
+    return items.view(np.uint8).reshape(-1, 3)
+
+
+class RadarRaster:
+    """One radar frame in a pixel buffer, redrawn by numpy in three layers.
+
+    The static base (rings, axes, labels) is rebuilt only when the size or
+    range changes, and aircraft are rasterized into a sparse overlay once
+    per snapshot; both are flattened into a "rest" frame.  Between
+    snapshots move() shifts the overlay to dead-reckoned positions,
+    recomposing just the pixels it leaves and covers.  Each sweep frame
+    then only touches the pixels under the sweep trail: last frame's trail
+    is restored from the rest frame and the new one painted from a
+    bearing-sorted pixel table and a colour ramp, with any aircraft pixels
+    in it blended back on top.  Rings and dots are anti-aliased by pixel
+    coverage; text uses the baked 5×7 font.  `scale` multiplies line, dot
+    and text sizes for HiDPI screens.
+
+    The frame is packed RGB living inside a ready-made binary PPM (what Tk
+    photos load fastest); rgba() gives the RGBA view of it.  After each
+    render(), `dirty` is the (x0, y0, x1, y1) box of pixels that changed.
+    """
+    SWEEP_TRAIL_DEG = 90
+    DOT_PX, SEL_DOT_PX = 3, 5
+    TEXT_CACHE = 8192                   # rendered idents kept for reuse
+
+    def __init__(self, width, height, scale=1):
+        if np is None:
+            raise RuntimeError("RadarRaster needs numpy")
+        self.width, self.height, self.scale = width, height, scale
+        self.cx, self.cy = width / 2, height / 2
+        self.r = min(width, height) / 2 - 8 * scale
+        head = b"P6 %d %d 255\n" % (width, height)
+        self._ppm = bytearray(head) + bytearray(width * height * 3)
+        self.rgb = np.frombuffer(self._ppm, dtype=np.uint8, offset=len(head)
+                                 ).reshape(height, width, 3)
+        self._flat = self.rgb.reshape(-1, 3)
+        self._flat_v = _packed(self._flat)
+
+        yy, xx = np.mgrid[0:height, 0:width].astype(np.float32)
+        dx, dy = xx + 0.5 - self.cx, yy + 0.5 - self.cy
+        self._dist = np.hypot(dx, dy)
+        inside = np.flatnonzero(self._dist <= self.r)
+        bear10 = np.rint(np.degrees(np.arctan2(dx, -dy)).ravel()[inside] * 10
+                         ).astype(np.int32) % 3600
+        order = np.argsort(bear10, kind="stable")
+        self._by_bear = inside[order]           # scope pixels in bearing order
+        self._bear10 = bear10[order]
+        self._trail = np.zeros(0, dtype=np.intp)
+
+        # Sweep colour for each tenth of a degree behind the beam.
+        frac = np.clip(1 - np.arange(3600) / (self.SWEEP_TRAIL_DEG * 10), 0, 1)
+        b = (frac * 0x28).astype(np.uint8)
+        self._sweep_lut = np.stack([b, b + 0x10 * (frac > 0), b], axis=1).astype(np.uint8)
+
+        self._discs = {}
+        self._text = {}
+        self._ov_at = np.full(width * height, -1, dtype=np.int32)
+        self._ov_idx = np.zeros(0, dtype=np.intp)
+        self._last = np.empty(width * height, dtype=np.int32)  # overlap scratch
+        self._rest = None
+        self.clear_targets()
+        self.draw_static(adsb_engine.RING_CAUTION_MI)
+
+    # ── Static layer ───────────────────────────────────────────────────────────
+    def draw_static(self, caution_mi):
+        s, cx, cy, r = self.scale, self.cx, self.cy, self.r
+        base = np.empty((self.height, self.width, 3), dtype=np.float32)
+        base[:] = _rgb(C["bg"])
+        if r > 0:
+            ix, iy = int(cx), int(cy)
+            top, bottom = max(int(cy - r), 0), min(int(cy + r) + 1, self.height)
+            left, right = max(int(cx - r), 0), min(int(cx + r) + 1, self.width)
+            half = s // 2
+            base[top:bottom, ix - half:ix - half + s] = _rgb(C["border"])
+            base[iy - half:iy - half + s, left:right] = _rgb(C["border"])
+            for frac, label, color in [
+                (RING_DANGER_MI / caution_mi, f"{RING_DANGER_MI:.1f}mi", C["red"]),
+                (RING_WARN_MI   / caution_mi, f"{RING_WARN_MI:.1f}mi",   C["orange"]),
+                (1.0,                         f"{caution_mi:.0f}mi",     C["text_dim"]),
+            ]:
+                rr = r * frac
+                cover = np.clip(s / 2 + 0.5 - np.abs(self._dist - rr), 0, 1)[..., None]
+                base += (np.array(_rgb(color), dtype=np.float32) - base) * cover
+                self._stamp_text(base, cx + rr - 4 * s, cy + 4 * s, label, color, s, "ne")
+            self._stamp_text(base, cx, cy, "+", C["green"], 2 * s, "center")
+            self._stamp_text(base, cx, cy - r + 10 * s, "N", C["text_dim"], s, "center")
+        self._base = np.rint(base).astype(np.uint8).reshape(-1, 3)
+        self._base_v = _packed(self._base)
+        self._compose_rest()
+
+    def _stamp_text(self, img, x, y, text, color, scale, anchor):
+        rows, cols = text_pixels(text, scale)
+        w, h = (len(text) * FONT_W - 1) * scale, FONT_H * scale
+        x0 = x - w if anchor == "ne" else x - w / 2 if anchor == "center" else x
+        y0 = y if anchor == "ne" else y - h / 2
+        rows, cols = rows + int(round(y0)), cols + int(round(x0))
+        ok = (rows >= 0) & (rows < self.height) & (cols >= 0) & (cols < self.width)
+        img[rows[ok], cols[ok]] = _rgb(color)
+
+    # ── Aircraft layer ─────────────────────────────────────────────────────────
+    def clear_targets(self):
+        self._sprite = self._anchor = None
+        self._set_overlay(np.zeros(0, dtype=np.uint8), np.zeros((0, 3), dtype=np.uint8),
+                          np.zeros(0, dtype=np.intp))
+
+    def _set_overlay(self, alpha, rgb, idx):
+        """Swap in a new aircraft overlay, recomposing only the pixels it changes."""
+        old = self._ov_idx
+        a = alpha.astype(np.uint16)[:, None]
+        self._ov_at[old] = -1
+        self._ov_idx, self._ov_inv = idx, 255 - a
+        self._ov_pre = rgb.astype(np.uint16) * a
+        self._ov_at[idx] = np.arange(len(idx), dtype=np.int32)
+        if self._rest is None:
+            return
+        rest_v, flat_v, base_v = self._rest_v, self._flat_v, self._base_v
+        px = base_v[old]
+        rest_v[old] = px
+        flat_v[old] = px
+        px = _packed(self._blend(_unpacked(base_v[idx]), slice(None)).astype(np.uint8))
+        rest_v[idx] = px
+        flat_v[idx] = px
+        both = [a for a in (old, idx) if len(a)]
+        if both:
+            # Full-width rows: the row span is just the smallest and largest index.
+            top = min(int(a.min()) for a in both) // self.width
+            bottom = max(int(a.max()) for a in both) // self.width + 1
+            m = self._moved or (0, top, self.width, bottom)
+            self._moved = (0, min(m[1], top), self.width, max(m[3], bottom))
+
+    def _blend(self, px, k):
+        """Aircraft overlay entries k blended over pixels px (n×3 uint8)."""
+        out = px.astype(np.uint16)
+        out *= self._ov_inv[k]
+        out += self._ov_pre[k]
+        out //= 255
+        return out
+
+    def _compose_rest(self):
+        rest = self._base.copy()
+        if len(self._ov_idx):
+            rest[self._ov_idx] = self._blend(rest[self._ov_idx], slice(None))
+        self._rest, self._rest_v = rest, _packed(rest)
+        self._flat[:] = rest
+        self._trail = np.zeros(0, dtype=np.intp)
+        self._prev_lo = None            # whole frame is new
+        self._moved = None
+
+    def set_table(self, table, slots, selected_hexid, caution_mi, east=None, north=None):
+        """Rasterize table rows by slot; later slots are drawn over earlier ones.
+
+        Positions come from the dist/bearing columns unless east/north
+        (mi, in slots order) are given.  Returns the (xs, ys) pixel position
+        of each slot for hit testing.
+        """
+        slots = np.asarray(slots, dtype=np.intp)
+        if not len(slots):
+            self.clear_targets()
+            return np.zeros(0), np.zeros(0)
+        s = self.scale
+        level = np.frombuffer(table.level, dtype=np.int8)[slots]
+        orbiting = np.frombuffer(table.orbiting, dtype=np.int8)[slots]
+        palette = np.array([_rgb(C["green_radar"]), _rgb(C["orange"]),
+                            _rgb(C["red"]), _rgb(C["cyan"])], dtype=np.uint8)
+        code = np.where((level == 0) & (orbiting != 0), 3, np.minimum(level, 2))
+        rgb = palette[code]
+        sel = table.slot_of.get(selected_hexid, -1)
+        big = slots == sel
+
+        # Each target's dot and label as pixel offsets from its anchor, in
+        # paint order — two passes so threats land on top of everything else.
+        parts = []
+        for group in (level == 0, level != 0):
+            for radius, pick in ((self.DOT_PX, group & ~big), (self.SEL_DOT_PX, group & big)):
+                k = np.flatnonzero(pick)
+                if len(k):
+                    dy, dx, cover = self._disc(radius * s)
+                    parts.append((np.repeat(k, len(dy)), np.tile(dy, len(k)),
+                                  np.tile(dx, len(k)), np.tile(cover, len(k))))
+            k = np.flatnonzero(group)
+            if len(k):
+                parts.append(self._label_sprites(
+                    k, [Aircraft(table, int(slots[j])).ident for j in k]))
+        owner, dy, dx, alpha = (np.concatenate(col) for col in zip(*parts))
+        self._sprite = (owner, dy, dx, alpha, _packed(rgb)[owner])
+        self._anchor = None
+
+        if east is None:
+            d = np.frombuffer(table.dist, dtype=np.float64)[slots]
+            b = np.radians(np.frombuffer(table.bearing, dtype=np.float64)[slots])
+            east, north = d * np.sin(b), d * np.cos(b)
+        return self.move(east, north, caution_mi)
+
+    def move(self, east, north, caution_mi):
+        """Re-place the last set_table() targets at east/north miles from own-ship.
+
+        Nothing is redrawn unless a target changed pixel, and then only the
+        targets' own pixels are, so a frame costs the same on any scope
+        size.  Returns (xs, ys) like set_table().
+        """
+        if self._sprite is None:
+            return np.zeros(0), np.zeros(0)
+        east = np.asarray(east, dtype=np.float64)
+        north = np.asarray(north, dtype=np.float64)
+        f = self.r / np.maximum(np.hypot(east, north), caution_mi)   # pinned to the rim
+        xs, ys = self.cx + east * f, self.cy - north * f
+        ix, iy = np.floor(xs).astype(np.intp), np.floor(ys).astype(np.intp)
+        anchor = self._anchor
+        if anchor is not None and np.array_equal(ix, anchor[0]) and np.array_equal(iy, anchor[1]):
+            return xs, ys
+        self._anchor = (ix, iy)
+
+        owner, dy, dx, alpha, rgb = self._sprite
+        rows, cols = iy[owner] + dy, ix[owner] + dx
+        ok = np.flatnonzero((rows >= 0) & (rows < self.height) & (cols >= 0) & (cols < self.width))
+        idx = rows[ok] * self.width + cols[ok]
+        # Where targets overlap the later one wins, as if painted in order.
+        n = np.arange(len(idx), dtype=np.int32)
+        last = self._last
+        last[idx] = n
+        win = np.flatnonzero(last[idx] == n)
+        keep = ok[win]
+        self._set_overlay(alpha[keep], _unpacked(rgb[keep]), idx[win])
+        return xs, ys
+
+    def _disc(self, radius):
+        disc = self._discs.get(radius)
+        if disc is None:
+            n = int(math.ceil(radius)) + 1
+            dy, dx = np.mgrid[-n:n + 1, -n:n + 1]
+            cover = np.clip(radius + 0.5 - np.hypot(dx, dy), 0, 1)
+            keep = cover > 0
+            disc = self._discs[radius] = (dy[keep], dx[keep],
+                                          np.rint(cover[keep] * 255).astype(np.uint8))
+        return disc
+
+    def _label_sprites(self, k, labels):
+        """(owner, dy, dx, alpha) of the ident labels for targets k."""
+        s = self.scale
+        cache = self._text
+        if len(cache) > self.TEXT_CACHE:
+            cache.clear()
+        sprites = []
+        for text in labels:
+            px = cache.get(text)
+            if px is None:
+                px = cache[text] = text_pixels(text, s)
+            sprites.append(px)
+        counts = np.fromiter((len(p[0]) for p in sprites), dtype=np.intp, count=len(sprites))
+        owner = np.repeat(k, counts)
+        # Anchored west of a point 6 px right of and above the dot, like Tk's.
+        dy = np.concatenate([p[0] for p in sprites]) + int(round(-6 * s - FONT_H * s / 2))
+        dx = np.concatenate([p[1] for p in sprites]) + 6 * s
+        return owner, dy, dx, np.full(len(owner), 255, dtype=np.uint8)
+
+    # ── Frame ──────────────────────────────────────────────────────────────────
+    def render(self, sweep_deg):
+        """Move the sweep to sweep_deg; returns the (height, width, 3) frame."""
+        flat_v = self._flat_v
+        flat_v[self._trail] = self._rest_v[self._trail]
+        s10 = int(round(sweep_deg * 10)) % 3600
+        lo = s10 - self.SWEEP_TRAIL_DEG * 10 + 1
+        ss = self._bear10.searchsorted
+        if lo >= 0:
+            spans = [slice(ss(lo), ss(s10, "right"))]
+        else:
+            spans = [slice(ss(lo + 3600), None), slice(0, ss(s10, "right"))]
+        trail = np.concatenate([self._by_bear[sp] for sp in spans])
+        behind = (s10 - np.concatenate([self._bear10[sp] for sp in spans])) % 3600
+        px = self._sweep_lut[behind]
+        np.maximum(px, _unpacked(self._base_v[trail]), out=px)
+        k = self._ov_at[trail]
+        hit = np.flatnonzero(k >= 0)
+        if len(hit):
+            px[hit] = self._blend(px[hit], k[hit])
+        flat_v[trail] = _packed(px)
+        self._trail = trail
+        lo_deg = lo / 10
+        if self._prev_lo is None:
+            self.dirty = (0, 0, self.width, self.height)
+        else:
+            span = (s10 / 10 - self._prev_lo) % 360
+            box = self.dirty = self._wedge_box(self._prev_lo, self._prev_lo + span)
+            m = self._moved
+            if m is not None:
+                self.dirty = (min(m[0], box[0]), min(m[1], box[1]),
+                              max(m[2], box[2]), max(m[3], box[3]))
+        self._moved = None
+        self._prev_lo = lo_deg % 360
+        return self.rgb
+
+    def _wedge_box(self, a0, a1):
+        """Pixel box around the scope sector from bearing a0 clockwise to a1."""
+        if a1 - a0 >= 270:
+            return 0, 0, self.width, self.height
+        cx, cy, r = self.cx, self.cy, self.r
+        angles = [a0, a1] + [k * 90 for k in range(int(a0 // 90) + 1, int(a1 // 90) + 1)]
+        xs = [cx] + [cx + r * math.sin(math.radians(a)) for a in angles]
+        ys = [cy] + [cy - r * math.cos(math.radians(a)) for a in angles]
+        return (max(int(min(xs)) - 1, 0), max(int(min(ys)) - 1, 0),
+                min(int(max(xs)) + 2, self.width), min(int(max(ys)) + 2, self.height))
+
+    def rgba(self):
+        out = np.empty((self.height, self.width, 4), dtype=np.uint8)
+        out[..., :3] = self.rgb
+        out[..., 3] = 255
+        return out
+
+    def ppm(self):
+        """The current frame as binary PPM, the cheapest format Tk photos load."""
+        return bytes(self._ppm)
+
+
+# ── Benchmark ──────────────────────────────────────────────────────────────────
+def benchmark(size, scale, counts, frames=50):
+    import random
+    rnd = random.Random(1)
+    for n in counts:
+        tbl = adsb_engine.AircraftTable()
+        for k in range(n):
+            slot = tbl.upsert("%06x" % k)
+            tbl.dist[slot] = rnd.uniform(0, adsb_engine.RING_CAUTION_MI)
+            tbl.bearing[slot] = rnd.uniform(0, 360)
+            tbl.level[slot] = rnd.choice((0, 0, 0, 0, 1, 2))
+            tbl.orbiting[slot] = 0
+            tbl.flight[slot] = "N%dAB" % k
+            tbl.tail[slot] = None
+        snap = tbl.freeze()
+        slots = list(snap.slot_of.values())
+        rr = RadarRaster(size, size, scale)
+        t0 = time.perf_counter()
+        rr.set_table(snap, slots, None, adsb_engine.RING_CAUTION_MI)
+        cold = time.perf_counter() - t0
+        t0 = time.perf_counter()                # idents now cached, as in steady state
+        rr.set_table(snap, slots, None, adsb_engine.RING_CAUTION_MI)
+        t1 = time.perf_counter()
+        for f in range(frames):
+            rr.render(f * 3)
+        t2 = time.perf_counter()
+        for f in range(frames):
+            rr.ppm()
+        t3 = time.perf_counter()
+        # Every target a pixel further out each frame: the worst case for move().
+        b = np.radians(np.frombuffer(snap.bearing, dtype=np.float64)[slots])
+        d = np.frombuffer(snap.dist, dtype=np.float64)[slots]
+        step = adsb_engine.RING_CAUTION_MI / rr.r * 1.5
+        for f in range(frames):
+            rr.move((d + f * step) * np.sin(b), (d + f * step) * np.cos(b),
+                    adsb_engine.RING_CAUTION_MI)
+        t4 = time.perf_counter()
+        print(f"{n:>5} targets  {size}x{size}@{scale}x  snapshot {(t1 - t0) * 1e3:6.2f} ms "
+              f"(cold {cold * 1e3:6.2f})  "
+              f"frame {(t2 - t1) / frames * 1e3:5.2f} ms  ppm {(t3 - t2) / frames * 1e3:5.2f} ms  "
+              f"move {(t4 - t3) / frames * 1e3:5.2f} ms")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="radar rasterizer frame-time benchmark")
+    parser.add_argument("--size", type=int, default=216, help="scope edge in pixels")
+    parser.add_argument("--scale", type=int, default=1, help="HiDPI factor")
+    parser.add_argument("--targets", type=int, nargs="+", default=[100, 1000, 5000])
+    args = parser.parse_args()
+    benchmark(args.size, args.scale, args.targets)
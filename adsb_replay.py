@@ -0,0 +1,350 @@
+#!/usr/bin/env python3
+"""
+ADS-B replay servers – recorded feeds served back for testing without radios.
+
+SbsReplay plays an SBS/BaseStation capture (e.g. `nc localhost 30003 >
+capture.sbs`) to every client that connects, paced by the logged timestamps
+in each MSG line, the way readsb's port 30003 would have sent it.
+GpsdReplay does the same for a gpsd JSON capture (`gpspipe -w`), paced by
+the TPV/SKY times, after the client's ?WATCH like a real gpsd.  SerialReplay
+stands in for the receiver itself: a pseudo-terminal whose slave end plays
+an NMEA/UBX capture (`cat /dev/ttyAMA0 > capture.ubx`) to whoever opens it.
+Writes can be cut into small segments so the reader's reassembly gets
+exercised, and once the capture ends the connection is either held open and
+silent or dropped.  Run directly to point a live engine at a capture:
+
+    python3 adsb_replay.py sbs testdata/sbs_capture.sbs --port 30003
+    python3 adsb_replay.py gpsd testdata/gpsd_capture.json --port 2947
+    python3 adsb_replay.py serial testdata/gps_capture.ubx
+"""
+import json, os, pty, select, socket, struct, threading, time, tty, argparse
+from datetime import datetime
+
+
+def load_lines(path):
+    """Read a capture as a list of raw lines, each with its line ending kept."""
+    with open(path, "rb") as fh:
+        return [ln if ln.endswith(b"\n") else ln + b"\n" for ln in fh if ln.strip()]
+
+
+# ── Pacing ─────────────────────────────────────────────────────────────────────
+
+class _Player:
+    """Play recorded lines to one consumer at a time at the recorded pace.
+
+    speed scales the recorded pacing (0 sends as fast as the consumer takes
+    it); chunk, when set, splits every write into pieces of that many bytes.
+    At the end of the capture it is played again (loop), the consumer is
+    left connected and silent (hold) or dropped.  Subclasses say how a line
+    is timed and how bytes reach the consumer.
+    """
+
+    def __init__(self, lines, speed=1.0, chunk=None, loop=False, hold=True):
+        self.lines = list(lines)
+        self.speed = speed
+        self.chunk = chunk
+        self.loop = loop
+        self.hold = hold
+        self.clients = 0                # consumers served so far
+        self._running = False
+
+    def _clock(self, line):
+        """Recorded time of a line in seconds, or None if it carries none."""
+        return None
+
+    def _write(self, out, data):
+        out.sendall(data)
+
+    def _send(self, out, data):
+        if self.chunk:
+            for i in range(0, len(data), self.chunk):
+                self._write(out, data[i:i + self.chunk])
+        else:
+            self._write(out, data)
+
+    def _play(self, out, lines):
+        start = time.monotonic()
+        first = None
+        for line in lines:
+            if not self._running:
+                return
+            t = self._clock(line)
+            if self.speed and t is not None:
+                if first is None:
+                    first = t
+                delay = (t - first) / self.speed - (time.monotonic() - start)
+                if delay > 0:
+                    time.sleep(delay)
+            self._send(out, line)
+
+
+# ── TCP replay ─────────────────────────────────────────────────────────────────
+
+class _Replay(_Player):
+    """Serve recorded lines over TCP, one replay per connection."""
+
+    def __init__(self, lines, host="127.0.0.1", port=0, speed=1.0, chunk=None,
+                 loop=False, hold=True):
+        super().__init__(lines, speed, chunk, loop, hold)
+        self._sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self._sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self._sock.bind((host, port))
+        self._sock.listen()
+        self.host, self.port = self._sock.getsockname()[:2]
+
+    def start(self):
+        self._running = True
+        threading.Thread(target=self._accept, daemon=True).start()
+        return self
+
+    def stop(self):
+        self._running = False
+        try:
+            self._sock.shutdown(socket.SHUT_RDWR)   # wakes the blocked accept()
+        except OSError:
+            pass
+        self._sock.close()
+
+    def _accept(self):
+        while self._running:
+            try:
+                conn, _ = self._sock.accept()
+            except OSError:
+                return                  # listening socket closed by stop()
+            # Line-at-a-time writes: don't let Nagle hold one back for an ACK.
+            conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            self.clients += 1
+            threading.Thread(target=self._serve, args=(conn,), daemon=True).start()
+
+    def _serve(self, conn):
+        with conn:
+            try:
+                lines = self._handshake(conn)
+                while self._running and lines is not None:
+                    self._play(conn, lines)
+                    if not self.loop:
+                        break
+                # Sit on the open connection like an idle source until stopped.
+                while self._running and self.hold:
+                    time.sleep(0.05)
+            except OSError:
+                pass                    # client went away
+
+    def _handshake(self, conn):
+        """Lines to replay on this connection, or None to hang up."""
+        return self.lines
+
+
+# ── SBS / BaseStation ─────────────────────────────────────────────────────────
+
+def _sbs_clock(line):
+    """Seconds since midnight of the logged time in an SBS line, or None."""
+    f = line.split(b",")
+    if len(f) < 10 or not f[9]:
+        return None
+    try:
+        h, m, s = f[9].split(b":")
+        return int(h) * 3600 + int(m) * 60 + float(s)
+    except ValueError:
+        return None
+
+
+def load_sbs(path):
+    """Read an SBS capture, normalising every line to the CRLF readsb sends."""
+    return [ln.rstrip(b"\r\n") + b"\r\n" for ln in load_lines(path)]
+
+
+class SbsReplay(_Replay):
+    """readsb's SBS output port, paced by each MSG line's logged time."""
+
+    def _clock(self, line):
+        return _sbs_clock(line)
+
+
+# ── gpsd ───────────────────────────────────────────────────────────────────────
+
+class GpsdReplay(_Replay):
+    """A gpsd that replays a JSON capture.
+
+    Like gpsd, it sends the capture's VERSION banner on connect and nothing
+    more until the client asks for ?WATCH; each command received is kept in
+    `commands`.
+    """
+
+    def __init__(self, lines, *args, **kw):
+        super().__init__(lines, *args, **kw)
+        self.commands = []
+
+    def _handshake(self, conn):
+        lines = self.lines
+        if lines and b'"VERSION"' in lines[0]:
+            self._send(conn, lines[0])
+            lines = lines[1:]
+        buf = b""
+        while b"?WATCH" not in buf:
+            data = conn.recv(4096)
+            if not data:
+                return None
+            buf += data
+        self.commands.extend(c for c in buf.split(b"\n") if c.strip())
+        return lines
+
+    def _clock(self, line):
+        try:
+            text = json.loads(line).get("time")
+            return datetime.fromisoformat(text.replace("Z", "+00:00")).timestamp()
+        except (ValueError, AttributeError):
+            return None
+
+
+# ── Serial receiver ────────────────────────────────────────────────────────────
+
+_UBX_LEN = struct.Struct("<H")
+
+
+def load_serial(path):
+    """Split a raw receiver capture into NMEA sentences, UBX frames and the
+    junk between them, so each can be paced and written on its own."""
+    with open(path, "rb") as fh:
+        data = fh.read()
+
+    def sync(start, stop):
+        hits = [i for i in (data.find(b"$", start, stop), data.find(b"\xb5\x62", start, stop))
+                if i >= 0]
+        return min(hits) if hits else stop
+
+    records, pos, n = [], 0, len(data)
+    while pos < n:
+        if data[pos] == 0x24:                               # '$': to the newline,
+            end = data.find(b"\n", pos)                     # or a truncated one
+            end = sync(pos + 1, n if end < 0 else end + 1)  # to the next sync
+        elif data.startswith(b"\xb5\x62", pos) and pos + 6 <= n:
+            end = min(n, pos + 8 + _UBX_LEN.unpack_from(data, pos + 4)[0])
+        else:
+            end = sync(pos + 1, n)                          # junk
+        records.append(data[pos:end])
+        pos = end
+    return records
+
+
+def _serial_clock(record):
+    """Seconds since midnight of an RMC/GGA sentence or a NAV-PVT frame."""
+    if record[:1] == b"$":
+        f = record.split(b",")
+        if len(f) > 1 and f[0][3:6] in (b"RMC", b"GGA") and len(f[1]) >= 6:
+            try:
+                return int(f[1][0:2]) * 3600 + int(f[1][2:4]) * 60 + float(f[1][4:])
+            except ValueError:
+                return None
+    elif record[2:4] == b"\x01\x07" and len(record) >= 6 + 20:
+        hour, minute, sec = record[6 + 8:6 + 11]
+        nano = struct.unpack_from("<i", record, 6 + 16)[0]
+        return hour * 3600 + minute * 60 + sec + nano * 1e-9
+    return None
+
+
+class SerialReplay(_Player):
+    """A GPS receiver on a pseudo-terminal.
+
+    `device` names the slave end.  Each time a reader opens it the capture
+    is played from the start, as a receiver that was just plugged in would
+    stream; the slave is raw from the outset so binary UBX passes the line
+    discipline untouched.  A tty cannot hang up on its reader, so after the
+    capture the port just goes silent until it is closed.  Whatever the
+    reader writes to the receiver (a CFG-MSG, say) is kept in `commands`.
+    """
+
+    POLL_SEC = 0.02                     # how often a closed port is checked
+
+    def __init__(self, records, speed=1.0, chunk=None, loop=False):
+        super().__init__(records, speed, chunk, loop)
+        self.commands = bytearray()
+        self._master, slave = pty.openpty()
+        self.device = os.ttyname(slave)
+        tty.setraw(slave)
+        os.close(slave)                 # until a reader opens it the master sees HUP
+        self._thread = None
+
+    def start(self):
+        self._running = True
+        self._thread = threading.Thread(target=self._serve, daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        self._running = False
+        if self._thread:
+            self._thread.join(timeout=2.0)
+        os.close(self._master)
+
+    def _opened(self, timeout):
+        """Wait up to timeout for the slave to be open, keeping what the
+        reader wrote meanwhile; False while nobody has it open."""
+        p = select.poll()
+        p.register(self._master, select.POLLIN)
+        ev = p.poll(timeout * 1000)
+        if ev and ev[0][1] & select.POLLHUP:
+            time.sleep(timeout)         # HUP is level-triggered: don't spin on it
+            return False
+        if ev:
+            self.commands += os.read(self._master, 4096)
+        return True
+
+    def _clock(self, record):
+        return _serial_clock(record)
+
+    def _write(self, out, data):
+        while data:
+            data = data[os.write(out, data):]
+
+    def _serve(self):
+        while self._running:
+            if not self._opened(self.POLL_SEC):
+                continue
+            self.clients += 1
+            try:
+                while self._running:
+                    self._play(self._master, self.lines)
+                    if not self.loop:
+                        break
+                while self._running and self._opened(0.05):
+                    pass
+            except OSError:
+                pass                    # reader closed the port mid-play
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="serve recorded ADS-B and GPS feeds")
+    sub = parser.add_subparsers(dest="kind", required=True)
+    for kind, port, what in (("sbs", 30003, "an SBS/BaseStation capture over TCP"),
+                             ("gpsd", 2947, "a gpsd JSON capture (gpspipe -w) over TCP"),
+                             ("serial", None, "a raw NMEA/UBX capture on a pseudo-terminal")):
+        p = sub.add_parser(kind, help=f"replay {what}")
+        p.add_argument("capture")
+        if port:
+            p.add_argument("--host", default="127.0.0.1")
+            p.add_argument("--port", type=int, default=port)
+            p.add_argument("--hangup", action="store_true",
+                           help="close the connection at the end instead of going silent")
+        p.add_argument("--speed", type=float, default=1.0,
+                       help="pacing multiplier; 0 sends without delay")
+        p.add_argument("--chunk", type=int, default=None,
+                       help="split writes into segments of this many bytes")
+        p.add_argument("--loop", action="store_true", help="restart the capture at the end")
+    args = parser.parse_args()
+    if args.kind == "sbs":
+        srv = SbsReplay(load_sbs(args.capture), args.host, args.port, args.speed,
+                        args.chunk, args.loop, not args.hangup)
+    elif args.kind == "gpsd":
+        srv = GpsdReplay(load_lines(args.capture), args.host, args.port, args.speed,
+                         args.chunk, args.loop, not args.hangup)
+    else:
+        srv = SerialReplay(load_serial(args.capture), args.speed, args.chunk, args.loop)
+    srv.start()
+    where = srv.device if args.kind == "serial" else f"{srv.host}:{srv.port}"
+    print(f"serving {len(srv.lines)} {args.kind} records on {where}")
+    try:
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        srv.stop()
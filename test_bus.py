@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""Shared-memory snapshot bus: one writer and eight reader processes.
+
+Every record of frame k carries k, so a reader that ever accepts a frame
+mixing two publishes, or one older than a frame it already returned, is
+caught.  The ring is kept short so the writer laps slow readers often,
+and every CORRUPT_EVERY-th frame has a record byte flipped after its seq
+was closed but before the head names it, as a store landing out of order
+would; only the CRC can catch that.
+"""
+import os, time, tempfile, unittest, multiprocessing
+from array import array
+from unittest import mock
+
+import adsb_engine
+from adsb_engine import (SnapshotBus, SnapshotBusReader, BusEngine, ThreatSnapshot,
+                         AircraftTable, _BUS_HEAD_SIZE, _BUS_FRAME_SIZE, _BUS_SEQ)
+
+READERS = 8
+RECORDS = 200
+STRESS_SEC = 3.0
+CORRUPT_EVERY = 7
+
+
+def _table(n):
+    t = AircraftTable()
+    for i in range(n):
+        slot = t.upsert("%06x" % i)
+        t.flight[slot] = "T%d" % i
+        t.level[slot] = i % 3
+    return t
+
+
+class CorruptingBus(SnapshotBus):
+    """Flips a record byte of every CORRUPT_EVERY-th frame before publishing it."""
+
+    def _write_head(self):
+        k = self.head
+        if k and k % CORRUPT_EVERY == 0:
+            off = _BUS_HEAD_SIZE + (k % self.frames) * self.frame_size
+            self._mm[off + _BUS_FRAME_SIZE + 3] ^= 0xFF
+        super()._write_head()
+
+
+def _publish(bus, t, k):
+    """Publish frame k with every record stamped k."""
+    n = len(t.hexid)
+    for slot in range(n):
+        t.rx[slot] = t.ry[slot] = float(k)
+        t.dist[slot] = k + slot / n             # keeps the records distinct
+    bus.publish(ThreatSnapshot(
+        seq=k, gps_ok=True, my_lat=40.0, my_lon=-75.0, sdr_ok=True,
+        sdr_status="SDR: OK", total_ac_seen=n, table=t,
+        threats=array("l", range(10)), safe_ac=array("l", range(10, n)),
+        stage_ms=(0.0, 0.0, 0.0), published=time.time()))
+
+
+def _reader(path, deadline, out):
+    r = SnapshotBusReader(path)
+    last, bad, first, seqs = 0, [], None, []
+    while time.time() < deadline:
+        snap = r.poll()
+        if snap is None:
+            continue
+        t = snap.table
+        k = snap.seq
+        if first is None:
+            first = k
+        if k <= last:
+            bad.append(("stale", last, k))
+        if (len(t.hexid) != RECORDS or len(snap.threats) != 10
+                or any(x != k for x in t.rx) or any(y != k for y in t.ry)):
+            bad.append(("mixed", k))
+        last = k
+        seqs.append(k)
+    out.put(dict(first=first, last=last, bad=bad[:5], seqs=seqs, read=r.frames_read,
+                 skipped=r.frames_skipped, retries=r.retries, crc=r.crc_rejects))
+    r.close()
+
+
+def _bus_path():
+    base = "/dev/shm" if os.path.isdir("/dev/shm") else tempfile.gettempdir()
+    return os.path.join(base, "adsb-test-bus-%d" % os.getpid())
+
+
+class SnapshotBusStressTest(unittest.TestCase):
+
+    def setUp(self):
+        self.path = _bus_path()
+        self.bus = CorruptingBus(self.path, frames=2, max_records=RECORDS)
+        self.table = _table(RECORDS)
+        _publish(self.bus, self.table, 1)
+
+    def tearDown(self):
+        self.bus.close()
+
+    def test_one_writer_eight_readers(self):
+        ctx = multiprocessing.get_context("fork")
+        out = ctx.Queue()
+        deadline = time.time() + STRESS_SEC
+        procs = [ctx.Process(target=_reader, args=(self.path, deadline, out))
+                 for _ in range(READERS)]
+        for p in procs:
+            p.start()
+        k = 1
+        while time.time() < deadline:
+            k += 1
+            _publish(self.bus, self.table, k)
+            time.sleep(0.002)               # let readers catch most frames whole
+        stats = [out.get(timeout=10) for _ in procs]
+        for p in procs:
+            p.join(timeout=10)
+        for s in stats:
+            self.assertEqual(s["bad"], [])
+            self.assertIsNotNone(s["first"])
+            # Every publish between a reader's first and last frame was either
+            # read or counted as skipped — none vanished or was double-counted.
+            self.assertEqual(s["read"] + s["skipped"], s["last"] - s["first"] + 1)
+            self.assertGreater(s["read"], 10)
+            self.assertTrue(all(k % CORRUPT_EVERY for k in s["seqs"]))
+        torn = sum(s["retries"] for s in stats)
+        crc = sum(s["crc"] for s in stats)
+        self.assertGreater(crc, 0)
+        if os.environ.get("BUS_STRESS_VERBOSE"):
+            print(f"\n{k} frames published; per reader read "
+                  f"{min(s['read'] for s in stats)}-{max(s['read'] for s in stats)}; "
+                  f"torn retries {torn}, CRC rejects {crc}")
+
+
+class SnapshotBusRejectTest(unittest.TestCase):
+
+    def setUp(self):
+        self.path = _bus_path()
+        self.bus = SnapshotBus(self.path, frames=2, max_records=RECORDS)
+        self.table = _table(RECORDS)
+        self.reader = SnapshotBusReader(self.path)
+
+    def tearDown(self):
+        self.reader.close()
+        self.bus.close()
+
+    def _frame_off(self, k):
+        return _BUS_HEAD_SIZE + (k % self.bus.frames) * self.bus.frame_size
+
+    def test_corrupt_frame_fails_crc(self):
+        _publish(self.bus, self.table, 1)
+        self.assertEqual(self.reader.poll().seq, 1)
+        _publish(self.bus, self.table, 2)
+        # A store that landed late: the seq says complete, a record disagrees.
+        pos = self._frame_off(2) + _BUS_FRAME_SIZE + 3
+        self.bus._mm[pos] ^= 0xFF
+        self.assertIsNone(self.reader.poll())
+        self.assertEqual((self.reader.crc_rejects, self.reader.frames_read), (8, 1))
+        _publish(self.bus, self.table, 3)
+        snap = self.reader.poll()
+        self.assertEqual(snap.seq, 3)
+        self.assertEqual(self.reader.frames_skipped, 1)
+
+    def test_writer_stopped_mid_frame(self):
+        _publish(self.bus, self.table, 1)
+        self.reader.poll()
+        _publish(self.bus, self.table, 2)
+        # The head already names frame 2, but its seq is back to "writing".
+        _BUS_SEQ.pack_into(self.bus._mm, self._frame_off(2), 2 * 2 - 1)
+        self.assertIsNone(self.reader.poll())
+        self.assertEqual((self.reader.retries, self.reader.crc_rejects), (8, 0))
+        _publish(self.bus, self.table, 3)
+        self.assertEqual(self.reader.poll().seq, 3)
+
+
+def _wait(cond, timeout=5.0):
+    end = time.monotonic() + timeout
+    while time.monotonic() < end:
+        if cond():
+            return True
+        time.sleep(0.01)
+    return cond()
+
+
+class BusEngineRestartTest(unittest.TestCase):
+
+    def setUp(self):
+        self.path = _bus_path()
+        self.table = _table(RECORDS)
+        self.bus = SnapshotBus(self.path, frames=2, max_records=RECORDS)
+        self.shown = []
+        self.engine = BusEngine(self.path, on_publish=self._shown)
+        patch = mock.patch.object(adsb_engine, "BUS_POLL_SEC", 0.01)
+        patch.start()
+        self.addCleanup(patch.stop)
+
+    def _shown(self):
+        snap = self.engine.latest
+        self.shown.append((snap.seq, snap.sdr_status))
+
+    def tearDown(self):
+        self.engine.stop()
+        self.bus.close()
+
+    def test_daemon_restart(self):
+        self.engine.start()
+        for k in (1, 2, 3):
+            _publish(self.bus, self.table, k)
+        self.assertTrue(_wait(lambda: self.shown and self.shown[-1][0] == 3))
+        # The daemon exits (unlinking the bus) and a new one takes its place,
+        # numbering its snapshots from 1 again.
+        self.bus.close()
+        self.bus = SnapshotBus(self.path, frames=2, max_records=RECORDS)
+        _publish(self.bus, self.table, 1)
+        self.assertTrue(_wait(lambda: self.shown[-1] == (1, "SDR: OK")))
+        self.assertIn((4, "ENGINE: OFFLINE"), self.shown)
+        _publish(self.bus, self.table, 2)
+        self.assertTrue(_wait(lambda: self.shown[-1] == (2, "SDR: OK")))
+        self.assertEqual(self.engine.reader.inode, os.stat(self.path).st_ino)
+
+    def test_stalled_writer(self):
+        with mock.patch.object(adsb_engine, "BUS_STALE_SEC", 0.3):
+            self.engine.start()
+            _publish(self.bus, self.table, 1)
+            self.assertTrue(_wait(lambda: self.shown == [(1, "SDR: OK")]))
+            # No new frame: offline once, however long it lasts.
+            self.assertTrue(_wait(lambda: len(self.shown) == 2))
+            time.sleep(1.5)
+            self.assertEqual(self.shown, [(1, "SDR: OK"), (2, "ENGINE: OFFLINE")])
+            # Publishing again brings it back without replaying the old frame.
+            _publish(self.bus, self.table, 2)
+            self.assertTrue(_wait(lambda: len(self.shown) == 3))
+        self.assertEqual(self.shown[-1], (2, "SDR: OK"))
+
+
+if __name__ == "__main__":
+    unittest.main()
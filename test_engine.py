@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""ThreatEngine / FleetEngine construction and per-cycle behaviour, no Tk."""
+import time, unittest
+from unittest import mock
+
+import adsb_engine
+from adsb_engine import (ThreatEngine, FleetEngine, Observer, GpsFix, AircraftSnapshot,
+                         MI_PER_DEG, MPH_PER_MPS, MPH_PER_KT)
+
+
+def _forbid(name):
+    def fail(*_, **__):
+        raise AssertionError(f"{name} must not be constructed")
+    return fail
+
+
+class AudioWiringTest(unittest.TestCase):
+
+    def test_fleet_never_starts_audio(self):
+        site = Observer("north", 40.0, -75.0, 10.0, 3.0, 1.0, 5000.0, 0.0)
+        with mock.patch.object(adsb_engine, "AudioMixer", _forbid("AudioMixer")), \
+             mock.patch.object(adsb_engine, "PhraseEngine", _forbid("PhraseEngine")), \
+             mock.patch.object(adsb_engine, "AudioEngine", _forbid("AudioEngine")):
+            engine = FleetEngine([site])
+        self.assertIsNone(engine.audio)
+
+    def test_threat_engine_takes_injected_audio(self):
+        audio = mock.Mock()
+        with mock.patch.object(adsb_engine, "AudioEngine", _forbid("AudioEngine")):
+            engine = ThreatEngine(audio=audio)
+        self.assertIs(engine.audio, audio)
+
+    def test_threat_engine_builds_audio_by_default(self):
+        with mock.patch.object(adsb_engine, "AudioEngine") as cls:
+            engine = ThreatEngine()
+        cls.assert_called_once_with()
+        self.assertIs(engine.audio, cls.return_value)
+
+    def test_beep_latency_is_measured(self):
+        audio = adsb_engine.AudioEngine(sink=adsb_engine.NullSink(), synth=lambda _: b"")
+        try:
+            self.assertIsNone(audio.beep_latency_ms)
+            audio.danger_tone()
+            end = time.monotonic() + 5.0
+            while audio.beep_latency_ms is None and time.monotonic() < end:
+                time.sleep(0.01)
+            self.assertGreaterEqual(audio.beep_latency_ms, 0.0)
+            self.assertIsNone(audio.mixer.latency_ms["speech"])
+            self.assertFalse(hasattr(audio, "speak"))
+        finally:
+            audio.mixer.stop()
+
+
+class ClockDomainTest(unittest.TestCase):
+
+    def test_own_ship_at_snapshot_instant(self):
+        # readsb's clock is an hour behind ours and the GPS receiver's an hour
+        # ahead; the write was read at once, one second after the last fix.
+        engine = ThreatEngine(audio=mock.Mock())
+        engine.json_watch = None
+        now = time.time()
+        engine.gps_fix = GpsFix(40.0, -75.0, 3, now + 3600, 20.0, 0.0, 3.0, now - 1.0)
+        snap = AircraftSnapshot.from_rows(now - 3600, 0, [])
+        with mock.patch.object(engine, "_read_snapshot", return_value=snap):
+            engine._cycle()
+        moved = (engine.latest.my_lat - 40.0) * MI_PER_DEG
+        self.assertAlmostEqual(moved, 20.0 * MPH_PER_MPS / 3600, delta=0.002)
+
+    def test_report_time_on_local_clock(self):
+        # readsb is an hour behind.  An earlier write was read at once, so the
+        # offset is known; this one sat 0.8 s before we read it, and its
+        # aircraft's position was 0.5 s old when it was written.
+        engine = ThreatEngine(audio=mock.Mock())
+        engine.json_watch = None
+        now = time.time()
+        engine._clock.update(now - 10 - 3600, now - 10)
+        engine.gps_fix = GpsFix(40.0, -75.0, 3, None, 0.0, 0.0, 3.0, now)
+        row = ("a1b2c3", 40.0 + 1 / MI_PER_DEG, -75.0, 1000.0, 180.0, 100.0, "N1", 0.5, 0.0)
+        snap = AircraftSnapshot.from_rows(now - 0.8 - 3600, 1, [row])
+        with mock.patch.object(engine, "_read_snapshot", return_value=snap):
+            engine._cycle()
+        tbl = engine.table
+        slot = tbl.slot_of["a1b2c3"]
+        self.assertAlmostEqual(tbl.pos_t[slot], now - 0.8 - 0.5, delta=0.05)
+        # The ring check dead-reckons over the full 1.3 s, not 0.5 s.
+        self.assertAlmostEqual(tbl.dist[slot], 1 - 1.3 * 100 * MPH_PER_KT / 3600, delta=0.002)
+
+    def test_report_ahead_of_now_not_run_backwards(self):
+        # A report stamped after the cycle's now (readsb's seen rounded below
+        # zero) is taken at its reported range, not dead-reckoned back out.
+        engine = ThreatEngine(audio=mock.Mock())
+        engine.json_watch = None
+        now = time.time()
+        engine.gps_fix = GpsFix(40.0, -75.0, 3, None, 0.0, 0.0, 3.0, now)
+        row = ("a1b2c3", 40.0 + 1 / MI_PER_DEG, -75.0, 1000.0, 180.0, 100.0, "N1", -2.0, 0.0)
+        snap = AircraftSnapshot.from_rows(now, 1, [row])
+        with mock.patch.object(engine, "_read_snapshot", return_value=snap):
+            engine._cycle()
+        tbl = engine.table
+        slot = tbl.slot_of["a1b2c3"]
+        self.assertGreater(tbl.pos_t[slot], now)
+        self.assertAlmostEqual(tbl.dist[slot], 1.0, delta=0.002)
+
+
+if __name__ == "__main__":
+    unittest.main()
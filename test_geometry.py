@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""Batch geometry kernels checked against the per-aircraft reference functions."""
+import contextlib, math, random, unittest
+from array import array
+from unittest import mock
+
+import adsb_engine
+from adsb_engine import (batch_geometry, batch_cpa, range_gate, haversine_miles,
+                         bearing_deg, GridIndex, GRID_CELL_DEG)
+
+
+def _ang(a, b):
+    """Smallest difference between two bearings, in degrees."""
+    return abs((a - b + 180.0) % 360.0 - 180.0)
+
+
+class BothPaths(unittest.TestCase):
+    """Runs each check with numpy and again with the scalar fallback."""
+
+    def both(self, check):
+        for name in ("numpy", "scalar"):
+            if name == "numpy" and adsb_engine.np is None:
+                continue
+            scalar = mock.patch.object(adsb_engine, "np", None)
+            with self.subTest(path=name), (scalar if name == "scalar" else contextlib.nullcontext()):
+                check()
+
+
+def traffic(rnd, my_lat, my_lon, n, spread=3.0, lon_spread=None):
+    lon_spread = spread if lon_spread is None else lon_spread
+    lats = array("d", (max(-89.999, min(89.999, my_lat + rnd.uniform(-spread, spread)))
+                       for _ in range(n)))
+    lons = array("d", ((my_lon + rnd.uniform(-lon_spread, lon_spread) + 180.0) % 360.0 - 180.0
+                       for _ in range(n)))
+    return lats, lons
+
+
+# Own-ship positions: mid-latitude, equator, far north, and astride the antimeridian.
+SITES = ((40.0, -75.0), (0.0, 0.0), (69.5, 18.9), (-36.8, 179.6), (51.5, -0.1))
+
+
+class BatchGeometryTest(BothPaths):
+
+    def test_matches_reference(self):
+        rnd = random.Random(4)
+
+        def check():
+            for my_lat, my_lon in SITES:
+                lats, lons = traffic(rnd, my_lat, my_lon, 500)
+                dist, bear, to_me = batch_geometry(lats, lons, my_lat, my_lon)
+                self.assertEqual(len(dist), len(lats))
+                for i in range(len(lats)):
+                    d = haversine_miles(my_lat, my_lon, lats[i], lons[i])
+                    self.assertAlmostEqual(dist[i], d, delta=1e-9)
+                    self.assertLess(_ang(bear[i], bearing_deg(my_lat, my_lon, lats[i], lons[i])), 1e-9)
+                    self.assertLess(_ang(to_me[i], bearing_deg(lats[i], lons[i], my_lat, my_lon)), 1e-9)
+                    self.assertTrue(0.0 <= bear[i] < 360.0 and 0.0 <= to_me[i] < 360.0)
+        self.both(check)
+
+    def test_index_subset_in_idx_order(self):
+        rnd = random.Random(5)
+        lats, lons = traffic(rnd, 40.0, -75.0, 200)
+        idx = array("l", [150, 3, 77, 3, 199])
+
+        def check():
+            full = batch_geometry(lats, lons, 40.0, -75.0)
+            part = batch_geometry(lats, lons, 40.0, -75.0, idx)
+            for col, sub in zip(full, part):
+                self.assertEqual([col[i] for i in idx], list(sub))
+        self.both(check)
+
+    def test_degenerate_inputs(self):
+        def check():
+            dist, bear, to_me = batch_geometry(array("d"), array("d"), 40.0, -75.0)
+            self.assertEqual((len(dist), len(bear), len(to_me)), (0, 0, 0))
+            # Own-ship's own position, and its antipode where a can round past 1;
+            # asin is ill-conditioned there, so only a loose bound holds.
+            dist, _, _ = batch_geometry(array("d", [40.0, -40.0]), array("d", [-75.0, 105.0]),
+                                        40.0, -75.0)
+            self.assertEqual(dist[0], 0.0)
+            self.assertAlmostEqual(dist[1], adsb_engine.EARTH_RADIUS_MI * math.pi, delta=0.01)
+        self.both(check)
+
+
+class RangeGateTest(BothPaths):
+
+    def test_never_rejects_in_range(self):
+        # Includes own-ship 0.05° from the pole, where the box opens to 180°.
+        rnd = random.Random(6)
+        sites = SITES + ((89.95, 10.0),)
+
+        def check():
+            for my_lat, my_lon in sites:
+                polar = my_lat > 80
+                lats, lons = traffic(rnd, my_lat, my_lon, 4000, spread=0.3,
+                                     lon_spread=180.0 if polar else None)
+                for ring in (1.0, 3.0, 10.0):
+                    kept = {int(i) for i in range_gate(lats, lons, my_lat, my_lon, ring)}
+                    inside = {i for i in range(len(lats))
+                              if haversine_miles(my_lat, my_lon, lats[i], lons[i]) <= ring}
+                    self.assertTrue(inside, (my_lat, my_lon, ring))
+                    self.assertLessEqual(inside, kept, (my_lat, my_lon, ring))
+                    if not polar:
+                        # The box is tight enough to be worth having.
+                        self.assertLess(len(kept), 2 * len(inside) + 10)
+        self.both(check)
+
+    def test_grid_matches_linear(self):
+        # Own-ship near the antimeridian and the pole makes the grid split or
+        # widen its box; the result must still be the linear gate's, in order.
+        rnd = random.Random(7)
+        sites = SITES + ((89.95, 10.0),)
+
+        def check():
+            for my_lat, my_lon in sites:
+                lats, lons = traffic(rnd, my_lat, my_lon, 3000, spread=0.5,
+                                     lon_spread=180.0 if my_lat > 80 else None)
+                grid = GridIndex(lons, lats, GRID_CELL_DEG)
+                for ring in (1.0, 3.0, 10.0):
+                    linear = [int(i) for i in range_gate(lats, lons, my_lat, my_lon, ring)]
+                    gridded = [int(i) for i in range_gate(lats, lons, my_lat, my_lon, ring, grid)]
+                    self.assertEqual(linear, gridded, (my_lat, my_lon, ring))
+        self.both(check)
+
+
+class GridIndexTest(BothPaths):
+
+    def test_query_covers_box(self):
+        rnd = random.Random(8)
+        xs = array("d", (rnd.uniform(-50, 50) for _ in range(2000)))
+        ys = array("d", (rnd.uniform(-50, 50) for _ in range(2000)))
+        xs[5] = float("nan")
+
+        def check():
+            grid = GridIndex(xs, ys, 3.0)
+            for _ in range(200):
+                x0, y0 = rnd.uniform(-60, 50), rnd.uniform(-60, 50)
+                x1, y1 = x0 + rnd.uniform(0, 20), y0 + rnd.uniform(0, 20)
+                got = [int(i) for i in grid.query(x0, y0, x1, y1)]
+                self.assertEqual(len(got), len(set(got)))
+                inside = {i for i in range(len(xs)) if x0 <= xs[i] <= x1 and y0 <= ys[i] <= y1}
+                self.assertLessEqual(inside, set(got))
+                self.assertNotIn(5, got)
+        self.both(check)
+
+
+def _row(rx, ry, vx, vy, agl, vrate):
+    """A batch_cpa row from an east/north relative position."""
+    return math.hypot(rx, ry), math.degrees(math.atan2(rx, ry)) % 360, vx, vy, agl, vrate
+
+
+NAN = float("nan")
+
+# (row, ring, expected time to CPA, miss, height at CPA, time to enter the ring),
+# worked by hand.
+CPA_CASES = (
+    # Head-on from 5 mi east at 180 mph, descending 300 ft/min: straight
+    # through own-ship 100 s out, 1 mi ring entered at 80 s.
+    (_row(5.0, 0.0, -0.05, 0.0, 1000.0, -300.0), 1.0, 100.0, 0.0, 500.0, 80.0),
+    # Same, no vertical rate: the height holds.
+    (_row(5.0, 0.0, -0.05, 0.0, 1000.0, NAN), 1.0, 100.0, 0.0, 1000.0, 80.0),
+    # Crossing 0.6 mi north, westbound at 144 mph from 3 mi east, climbing.
+    # CPA at 75 s; the 1 mi ring is 0.8 mi of track before it, 20 s.
+    (_row(3.0, 0.6, -0.04, 0.0, 2000.0, 120.0), 1.0, 75.0, 0.6, 2150.0, 55.0),
+    # The same crossing against a 0.5 mi ring never enters it.
+    (_row(3.0, 0.6, -0.04, 0.0, 2000.0, 120.0), 0.5, 75.0, 0.6, 2150.0, NAN),
+    # Receding 2 mi north: at CPA now, whatever the vertical rate.
+    (_row(0.0, 2.0, 0.0, 0.03, 800.0, 1000.0), 1.0, 0.0, 2.0, 800.0, NAN),
+    # Already inside the ring and closing: no entry time.
+    (_row(0.5, 0.0, -0.01, 0.0, 300.0, 0.0), 1.0, 50.0, 0.0, 300.0, NAN),
+    # Holding station: CPA is now.
+    (_row(2.0, 0.0, 0.0, 0.0, 500.0, 60.0), 1.0, 0.0, 2.0, 500.0, NAN),
+    # No velocity: nothing about the approach is known.
+    (_row(2.0, 0.0, NAN, NAN, 500.0, 60.0), 1.0, NAN, NAN, NAN, NAN),
+    (_row(2.0, 0.0, NAN, NAN, 500.0, NAN), 1.0, NAN, NAN, NAN, NAN),
+)
+
+
+class BatchCpaTest(BothPaths):
+
+    def _check_close(self, got, want, delta):
+        if want != want:
+            self.assertTrue(got != got, f"{got} is not NaN")
+        else:
+            self.assertAlmostEqual(got, want, delta=delta)
+
+    def test_hand_worked_cases(self):
+        cols = [array("d", c) for c in zip(*(case[0] for case in CPA_CASES))]
+        rings = array("d", (case[1] for case in CPA_CASES))
+
+        def check():
+            t, miss, h, enter = batch_cpa(*cols, rings)
+            for i, (_, _, *want) in enumerate(CPA_CASES):
+                with self.subTest(case=i):
+                    for got, exp, delta in zip((t[i], miss[i], h[i], enter[i]), want,
+                                               (1e-9, 1e-9, 1e-6, 1e-9)):
+                        self._check_close(float(got), exp, delta)
+        self.both(check)
+
+    def test_paths_agree(self):
+        if adsb_engine.np is None:
+            self.skipTest("numpy not installed")
+        rnd = random.Random(11)
+        n = 2000
+        col = lambda lo, hi: array("d", (rnd.uniform(lo, hi) for _ in range(n)))
+        dist, bear = col(0.1, 10.0), col(0.0, 360.0)
+        vx, vy = col(-0.06, 0.06), col(-0.06, 0.06)
+        agl, vrate = col(0.0, 5000.0), col(-2000.0, 2000.0)
+        for i in range(0, n, 17):
+            vx[i] = vy[i] = NAN
+        for i in range(0, n, 13):
+            vrate[i] = NAN
+        for ring in (3.0, col(0.5, 5.0)):
+            fast = batch_cpa(dist, bear, vx, vy, agl, vrate, ring)
+            with mock.patch.object(adsb_engine, "np", None):
+                slow = batch_cpa(dist, bear, vx, vy, agl, vrate, ring)
+            for a, b in zip(fast, slow):
+                for x, y in zip(a, b):
+                    self._check_close(float(x), y, 1e-6 * max(1.0, abs(y)))
+
+
+if __name__ == "__main__":
+    unittest.main()
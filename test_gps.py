@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+"""Own-ship GPS readers: gpsd over a socket and the receiver's own NMEA/UBX
+over a pseudo-terminal, both against the replay servers."""
+import os, time, threading, unittest
+from datetime import datetime, timezone
+from unittest import mock
+
+import adsb_engine
+from adsb_engine import (GpsdClient, NmeaReader, GpsFix, ClockOffset, MI_PER_DEG,
+                         MPH_PER_MPS, _ubx_frame)
+from adsb_replay import GpsdReplay, SerialReplay, load_lines, load_serial
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "testdata")
+
+
+def _wait(cond, timeout=5.0):
+    end = time.monotonic() + timeout
+    while time.monotonic() < end:
+        if cond():
+            return True
+        time.sleep(0.02)
+    return cond()
+
+
+def _epoch(text):
+    return datetime.fromisoformat(text).replace(tzinfo=timezone.utc).timestamp()
+
+
+class GpsdClientTest(unittest.TestCase):
+    # The capture: a no-fix TPV, eight 3D fixes one second apart heading north
+    # at 11.1 m/s, and a no-fix TPV after the fifth.
+    FIXES = 8
+
+    def setUp(self):
+        self.lines = load_lines(os.path.join(DATA, "gpsd_capture.json"))
+        self.got = []
+        self.srv = self.client = None
+
+    def tearDown(self):
+        if self.client:
+            self.client.stop()
+        if self.srv:
+            self.srv.stop()
+
+    def _run(self, **kw):
+        self.srv = GpsdReplay(self.lines, **kw).start()
+        self.client = GpsdClient(self.got.append, self.srv.host, self.srv.port)
+        threading.Thread(target=self.client.run, daemon=True).start()
+
+    def _fixes(self):
+        return [f for f in self.got if f is not None]
+
+    def test_chunked_stream(self):
+        # 5-byte writes: every TPV straddles several reads.
+        self._run(speed=0, chunk=5)
+        self.assertTrue(_wait(lambda: len(self._fixes()) == self.FIXES))
+        self.assertTrue(any(c.startswith(b"?WATCH") and b'"json":true' in c
+                            for c in self.srv.commands))
+        # The leading no-fix TPV says nothing; the one mid-stream is a loss.
+        kinds = ["fix" if f else "lost" for f in self.got]
+        self.assertEqual(kinds, ["fix"] * 5 + ["lost"] + ["fix"] * 3)
+        first = self._fixes()[0]
+        self.assertAlmostEqual(first.lat, 40.0001)
+        self.assertEqual((first.lon, first.mode, first.speed, first.track, first.eph),
+                         (-75.0, 3, 11.1, 0.0, 3.2))
+        self.assertEqual(first.time, _epoch("2024-06-01T12:00:01"))
+
+    def test_paced_fixes_arrive_as_sent(self):
+        self._run(speed=4.0)
+        self.assertTrue(_wait(lambda: len(self._fixes()) == self.FIXES))
+        received = [f.received for f in self._fixes()]
+        # 7 s of capture at 4x, published as each TPV lands.
+        self.assertGreater(received[-1] - received[0], 1.5)
+
+    def test_silence_reports_lost(self):
+        with mock.patch.object(adsb_engine, "GPS_STALE_SEC", 0.5):
+            self._run(speed=0, hold=True)
+            self.assertTrue(_wait(lambda: len(self._fixes()) == self.FIXES))
+            # The socket stays open but nothing more comes: one loss, no more.
+            self.assertTrue(_wait(lambda: self.got[-1] is None, 3.0))
+            time.sleep(1.5)
+        self.assertEqual(sum(f is None for f in self.got), 2)
+        self.assertEqual(self.srv.clients, 1)
+
+    def test_disconnect_reports_lost_and_reconnects(self):
+        self._run(speed=0, hold=False)
+        # gpsd hangs up at the end of the capture; the client reports the
+        # loss at once, reconnects and is fed the capture again.
+        self.assertTrue(_wait(lambda: len(self._fixes()) >= self.FIXES + 1))
+        self.assertGreaterEqual(self.srv.clients, 2)
+        i = self.FIXES + 1                          # the 8 fixes and the mid-stream loss
+        self.assertIsNone(self.got[i])
+        self.assertIsNotNone(self.got[i + 1])
+
+    def test_feed_byte_at_a_time(self):
+        junk = [b"garbage\n", b'{"class":"TPV","mode":3,"lat":\n', b"\n", b"[1,2]\n"]
+        client = GpsdClient(self.got.append)
+        for b in b"".join(junk + self.lines):
+            client.feed(bytes((b,)), now=1.0)
+        self.assertEqual(len(self._fixes()), self.FIXES)
+        self.assertEqual(len(self.got), self.FIXES + 1)
+        # Nothing is left over once the last line is complete.
+        self.assertEqual(len(client._buf) - client._pos, 0)
+
+
+class NmeaReaderTest(unittest.TestCase):
+    # Both captures fly the gpsd capture's track: eight fixes one second
+    # apart heading north at 11.1 m/s, and a no-fix epoch after the fifth.
+    # Around them: a sentence cut off mid-line at attach, boot noise, a
+    # GSV and TXT the reader ignores, an RMC/NAV-PVT for 51 N with a bad
+    # checksum, and an RMC/NAV-PVT truncated by the next sync.
+    FIXES = 8
+
+    def setUp(self):
+        self.got = []
+        self.srv = self.reader = None
+
+    def tearDown(self):
+        if self.reader:
+            self.reader.stop()
+        if self.srv:
+            self.srv.stop()
+
+    def _fixes(self):
+        return [f for f in self.got if f is not None]
+
+    def _check(self, eph):
+        kinds = ["fix" if f else "lost" for f in self.got]
+        self.assertEqual(kinds, ["fix"] * 5 + ["lost"] + ["fix"] * 3)
+        fixes = self._fixes()
+        self.assertEqual([round(f.lat, 6) for f in fixes],
+                         [40.0001, 40.0002, 40.0003, 40.0004, 40.0005, 40.0006,
+                          40.0007, 40.0008])
+        first = fixes[0]
+        self.assertEqual((first.lon, first.mode, first.track), (-75.0, 3, 0.0))
+        self.assertAlmostEqual(first.speed, 11.1, places=3)
+        self.assertAlmostEqual(first.eph, eph)
+        self.assertEqual(first.time, _epoch("2024-06-01T12:00:01"))
+
+    def _feed(self, name, ubx, step=None):
+        reader = NmeaReader(self.got.append, ubx=ubx)
+        with open(os.path.join(DATA, name), "rb") as fh:
+            data = fh.read()
+        step = step or len(data)
+        for i in range(0, len(data), step):
+            reader.feed(data[i:i + step], now=1.0)
+        return reader
+
+    def test_nmea_capture(self):
+        for step in (None, 1, 7):
+            with self.subTest(step=step):
+                del self.got[:]
+                reader = self._feed("gps_capture.nmea", False, step)
+                self._check(eph=0.9 * NmeaReader.UERE_M)
+                self.assertEqual(len(reader._buf) - reader._pos, 0)
+                self.assertEqual((reader.quality, reader.hdop), (1, 0.9))
+
+    def test_ubx_capture(self):
+        for step in (None, 1, 7):
+            with self.subTest(step=step):
+                del self.got[:]
+                reader = self._feed("gps_capture.ubx", True, step)
+                self._check(eph=3.2)
+                self.assertEqual(len(reader._buf) - reader._pos, 0)
+
+    def test_ubx_ignored_unless_enabled(self):
+        # The UBX capture's NMEA is GGA and TXT only, which never make a fix.
+        self._feed("gps_capture.ubx", False)
+        self.assertEqual(self.got, [])
+
+    def _run(self, name, ubx=False, **kw):
+        self.srv = SerialReplay(load_serial(os.path.join(DATA, name)), **kw).start()
+        self.reader = NmeaReader(self.got.append, self.srv.device, 9600, ubx)
+        threading.Thread(target=self.reader.run, daemon=True).start()
+
+    def test_pty_nmea(self):
+        self._run("gps_capture.nmea", speed=0, chunk=7)
+        self.assertTrue(_wait(lambda: len(self._fixes()) == self.FIXES))
+        self._check(eph=0.9 * NmeaReader.UERE_M)
+        self.assertEqual(self.srv.clients, 1)
+
+    def test_pty_ubx_configures_receiver(self):
+        self._run("gps_capture.ubx", ubx=True, speed=0)
+        self.assertTrue(_wait(lambda: len(self._fixes()) == self.FIXES))
+        self._check(eph=3.2)
+        # CFG-MSG: NAV-PVT on every solution, sent when the port was opened.
+        cfg = _ubx_frame(0x06, 0x01, bytes((0x01, 0x07, 1)))
+        self.assertTrue(_wait(lambda: cfg in self.srv.commands))
+
+    def test_pty_paced_fixes_arrive_as_sent(self):
+        self._run("gps_capture.nmea", speed=4.0)
+        self.assertTrue(_wait(lambda: len(self._fixes()) == self.FIXES))
+        received = [f.received for f in self._fixes()]
+        self.assertGreater(received[-1] - received[0], 1.5)
+
+    def test_unplugged_reports_lost(self):
+        self._run("gps_capture.nmea", speed=0)
+        self.assertTrue(_wait(lambda: len(self._fixes()) == self.FIXES))
+        self.srv.stop()                         # the device node goes away
+        self.srv = None
+        self.assertTrue(_wait(lambda: self.got[-1] is None))
+        self.assertEqual(len(self._fixes()), self.FIXES)
+
+
+class GpsFixTest(unittest.TestCase):
+    T = 1_700_000_000.0
+
+    def _fix(self, gps_time):
+        return GpsFix(40.0, -75.0, 3, gps_time, 10.0, 0.0, 3.0, self.T)
+
+    def test_dead_reckons_from_receipt(self):
+        # The receiver's clock is an hour out; only our receipt time counts.
+        for gps_time in (None, self.T - 3600, self.T + 3600):
+            lat, lon, vx, vy = self._fix(gps_time).at(self.T + 2)
+            self.assertAlmostEqual((lat - 40.0) * MI_PER_DEG, 2 * vy)
+            self.assertEqual((lon, vx), (-75.0, 0.0))
+            self.assertAlmostEqual(vy, 10.0 * MPH_PER_MPS / 3600)
+
+    def test_span_capped(self):
+        with mock.patch.object(adsb_engine, "GPS_STALE_SEC", 5.0):
+            lat, _, _, vy = self._fix(None).at(self.T + 60)
+        self.assertAlmostEqual((lat - 40.0) * MI_PER_DEG, 5 * vy)
+
+
+class ClockOffsetTest(unittest.TestCase):
+
+    def test_least_lag_in_window(self):
+        clock = ClockOffset()
+        local = 1_700_000_000.0
+        # readsb runs 3600 s behind; reads land 10-300 ms after each write.
+        for k, lag in enumerate((0.3, 0.01, 0.2, 0.15, 0.1)):
+            off = clock.update(local + k - 3600, local + k + lag)
+        self.assertAlmostEqual(off, 3600.01, places=4)
+        # Once the quickest read leaves the window the next-least takes over.
+        with mock.patch.object(adsb_engine, "CLOCK_OFFSET_WINDOW_SEC", 2.5):
+            off = clock.update(local + 5 - 3600, local + 5 + 0.2)
+        self.assertAlmostEqual(off, 3600.1, places=4)
+
+    def test_stepped_clock_followed(self):
+        clock = ClockOffset()
+        with mock.patch.object(adsb_engine, "CLOCK_OFFSET_WINDOW_SEC", 10):
+            for k in range(20):
+                clock.update(1000.0 + k, 1000.0 + k + 0.05)
+            # readsb's clock is stepped 2 s ahead: the offset shrinks at once.
+            self.assertAlmostEqual(clock.update(1022.0, 1020.05), -1.95)
+            # Stepped back, the old minimum ages out within the window.
+            for k in range(21, 40):
+                off = clock.update(1000.0 + k, 1000.0 + k + 0.05)
+            self.assertAlmostEqual(off, 0.05)
+
+    def test_local_snapshot(self):
+        clock = ClockOffset()
+        clock.update(100.0, 3700.0)
+        self.assertEqual(clock.update(None, 3701.0), 0.0)
+
+
+if __name__ == "__main__":
+    unittest.main()
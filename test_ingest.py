@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Ingest tests: SBS over TCP against the replay server, aircraft.json watching."""
+import os, json, shutil, tempfile, time, unittest
+
+import adsb_engine
+from adsb_engine import SbsFeed, AircraftJsonWatcher
+from adsb_replay import SbsReplay, load_sbs
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "testdata")
+
+
+def _wait(cond, timeout=5.0):
+    end = time.monotonic() + timeout
+    while time.monotonic() < end:
+        if cond():
+            return True
+        time.sleep(0.02)
+    return cond()
+
+
+class SbsReplayTest(unittest.TestCase):
+
+    def setUp(self):
+        self.lines = load_sbs(os.path.join(DATA, "sbs_capture.sbs"))
+        self.hits = []
+        self.srv = None
+        self.feed = None
+
+    def tearDown(self):
+        if self.feed:
+            self.feed.stop()
+        if self.srv:
+            self.srv.stop()
+
+    def _connect(self, **kw):
+        self.srv = SbsReplay(self.lines, **kw).start()
+        self.feed = SbsFeed(self.srv.host, self.srv.port,
+                            on_position=lambda: self.hits.append(time.monotonic()))
+        self.feed.start()
+        self.assertTrue(_wait(lambda: self.feed.connected))
+
+    def _settled(self):
+        # The capture's last position for each airborne track has gone through.
+        snap = self.feed.snapshot()
+        return ("a1b2c3" in snap.hexid and "4840d6" in snap.hexid
+                and snap.lon[snap.hexid.index("a1b2c3")] < -74.9875
+                and snap.lat[snap.hexid.index("4840d6")] > 40.0335)
+
+    def _check_final(self):
+        self.assertTrue(_wait(self._settled))
+        snap = self.feed.snapshot()
+        rows = {h: i for i, h in enumerate(snap.hexid)}
+        # The ground vehicle is tracked but has no altitude, so it is not a row.
+        self.assertEqual(snap.total, 3)
+        self.assertEqual(sorted(rows), ["4840d6", "a1b2c3"])
+        i = rows["a1b2c3"]
+        self.assertEqual(snap.flight[i], "N123AB")
+        # Last good position; the malformed and truncated lines changed nothing.
+        self.assertAlmostEqual(snap.lat[i], 40.0)
+        self.assertAlmostEqual(snap.lon[i], -74.988)
+        self.assertEqual(snap.alt[i], 800.0)
+        self.assertEqual(snap.track[i], 270.0)
+        self.assertEqual(snap.gs[i], 120.0)
+        self.assertEqual(snap.vrate[i], -256.0)
+        j = rows["4840d6"]
+        self.assertEqual(snap.flight[j], "KLM1023")
+        self.assertAlmostEqual(snap.lat[j], 40.034)
+
+    def test_split_segments(self):
+        # Every line cut into 7-byte writes: lines only count once complete.
+        self._connect(speed=0, chunk=7)
+        positions = sum(1 for ln in self.lines
+                        if ln.startswith(b"MSG,3") or ln.startswith(b"MSG,2"))
+        self._check_final()
+        self.assertTrue(0 < len(self.hits) <= positions)
+
+    def test_paced_pushes_positions_as_they_arrive(self):
+        # 4 s of capture at 4x: positions must trickle in, not land in one batch.
+        self._connect(speed=4.0)
+        self._check_final()
+        self.assertGreaterEqual(len(self.hits), 8)
+        self.assertGreater(self.hits[-1] - self.hits[0], 0.5)
+
+    def test_reconnects_after_server_restart(self):
+        self._connect(speed=0)
+        self.assertTrue(_wait(lambda: len(self.feed.snapshot()) == 2))
+        port = self.srv.port
+        self.srv.stop()
+        self.assertTrue(_wait(lambda: not self.feed.connected))
+        # The feed backs off 1 s before its first retry.
+        self.srv = SbsReplay(self.lines, port=port, speed=0).start()
+        self.assertTrue(_wait(lambda: self.srv.clients == 1 and self.feed.connected, 5.0))
+
+
+class JsonWatcherTest(unittest.TestCase):
+
+    def setUp(self):
+        self.tmp = tempfile.mkdtemp()
+        self.run_dir = os.path.join(self.tmp, "readsb")
+        os.mkdir(self.run_dir)
+        self.path = os.path.join(self.run_dir, "aircraft.json")
+        self.stamp = 1000.0
+        self.w = AircraftJsonWatcher(self.path)
+        if not self.w.watching:
+            self.skipTest("no inotify")
+
+    def tearDown(self):
+        if self.w._fd is not None:
+            os.close(self.w._fd)
+        shutil.rmtree(self.tmp, ignore_errors=True)
+
+    def _write(self, directory=None):
+        # readsb's write-then-rename.
+        self.stamp += 1.0
+        directory = directory or self.run_dir
+        tmp = os.path.join(directory, "aircraft.json.tmp")
+        with open(tmp, "w") as f:
+            json.dump({"now": self.stamp, "aircraft": [
+                {"hex": "a1b2c3", "lat": 40.0, "lon": -75.0, "alt_baro": 900}]}, f)
+        os.rename(tmp, os.path.join(directory, "aircraft.json"))
+
+    def _delivers(self):
+        self._write()
+        self.assertTrue(self.w.drain_events())
+        snap = self.w.poll()
+        self.assertEqual(snap.now, self.stamp)
+
+    def test_rearms_after_directory_recreated(self):
+        self._delivers()
+        shutil.rmtree(self.run_dir)
+        # IN_IGNORED: the watch is gone and callers must poll on the timer.
+        self.assertTrue(self.w.drain_events())
+        self.assertFalse(self.w.watching)
+        with self.assertRaises(OSError):
+            self.w.poll()
+        self.assertFalse(self.w.watching)
+        os.mkdir(self.run_dir)
+        self._write()
+        # The timer poll re-arms the watch and picks up the write it missed.
+        self.assertEqual(self.w.poll().now, self.stamp)
+        self.assertTrue(self.w.watching)
+        self._delivers()
+
+    def test_rearms_when_recreated_before_drain(self):
+        self._delivers()
+        shutil.rmtree(self.run_dir)
+        os.mkdir(self.run_dir)
+        self._write()
+        # The write landed with no watch on the new directory; the lost watch
+        # still reports a hit so it is read, and the drain re-arms on the path.
+        self.assertTrue(self.w.drain_events())
+        self.assertTrue(self.w.watching)
+        self.assertEqual(self.w.poll().now, self.stamp)
+        self._delivers()
+
+    def test_drops_watch_on_moved_directory(self):
+        self._delivers()
+        old = self.run_dir + ".old"
+        os.rename(self.run_dir, old)
+        self.assertTrue(self.w.drain_events())
+        self.assertFalse(self.w.watching)
+        # Writes into the moved-away directory are no longer ours.
+        self._write(old)
+        self.assertFalse(self.w.drain_events())
+        os.mkdir(self.run_dir)
+        self.assertFalse(self.w.drain_events())
+        self.assertTrue(self.w.watching)
+        self._delivers()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Closing-speed Kalman filter on simulated 1 Hz tracks with ADS-B noise."""
+import math, random, unittest
+
+from adsb_engine import (TrackStore, MI_PER_DEG, MPH_PER_KT, MIN_CLOSING_MPH,
+                         KF_CONFIDENCE_Z, KF_RESET_GAP_SEC)
+
+MY_LAT, MY_LON = 40.0, -75.0
+POS_NOISE_MI = 0.03
+T0 = 1_700_000_000.0
+
+
+def fly(seed, start_e, start_n, track, gs_kts, ticks=40, velocity=True):
+    """Report the filter's closing estimate each tick of a straight flight.
+
+    Returns [(flagged, closing_mph, true_closing_mph)] per tick.
+    """
+    rnd = random.Random(seed)
+    store = TrackStore(4)
+    rec = store.claim("a1b2c3", T0)
+    cos_me = math.cos(math.radians(MY_LAT))
+    speed = gs_kts * MPH_PER_KT / 3600                  # mi/s
+    ve, vn = speed * math.sin(math.radians(track)), speed * math.cos(math.radians(track))
+    out = []
+    for k in range(ticks):
+        t = T0 + k
+        e, n = start_e + ve * k, start_n + vn * k
+        lat = MY_LAT + (n + rnd.gauss(0, POS_NOISE_MI)) / MI_PER_DEG
+        lon = MY_LON + (e + rnd.gauss(0, POS_NOISE_MI)) / (cos_me * MI_PER_DEG)
+        if velocity:
+            # readsb rounds gs to 0.1 kt and track to 0.1 deg; add a little jitter.
+            gs, trk = round(gs_kts + rnd.gauss(0, 1.0), 1), round(track + rnd.gauss(0, 0.5), 1)
+        else:
+            gs, trk = float("nan"), None
+        store.filter_update(rec, lat, lon, gs, trk, t)
+        closing, sd = store.range_rate(rec, MY_LAT, MY_LON, t)
+        rng = math.hypot(e, n)
+        true = -(e * ve + n * vn) / rng * 3600
+        out.append((closing - KF_CONFIDENCE_Z * sd >= MIN_CLOSING_MPH, closing, true))
+    return out
+
+
+def first_flagged(run):
+    return next((k + 1 for k, (flag, _, _) in enumerate(run) if flag), None)
+
+
+def rms(run, skip=0):
+    err = [(c - t) ** 2 for _, c, t in run[skip:]]
+    return math.sqrt(sum(err) / len(err))
+
+
+class ClosingSpeedTest(unittest.TestCase):
+    SEEDS = range(20)
+
+    def test_head_on(self):
+        # 6 mi east, flying straight at own-ship: 115 mph closing.
+        for seed in self.SEEDS:
+            run = fly(seed, 6.0, 0.0, 270.0, 100)
+            self.assertEqual(first_flagged(run), 1)
+            self.assertTrue(all(flag for flag, _, _ in run))
+            self.assertLess(rms(run), 3.0)
+
+    def test_crossing(self):
+        # Passes 1 mi north of own-ship 47 s in; closing turns to opening.
+        for seed in self.SEEDS:
+            run = fly(seed, 1.5, 1.0, 270.0, 100, ticks=90)
+            self.assertEqual(first_flagged(run), 1)
+            self.assertLess(rms(run), 3.0)
+            # Past the closest point it must no longer read as closing.
+            past = [flag for flag, _, true in run if true < -MIN_CLOSING_MPH * 4]
+            self.assertTrue(past and not any(past))
+
+    def test_receding_never_flagged(self):
+        for seed in self.SEEDS:
+            for track, start in ((90.0, (2.0, 0.0)), (45.0, (0.5, 0.5)), (0.0, (-1.0, 1.0))):
+                run = fly(seed, *start, track, 100)
+                self.assertIsNone(first_flagged(run), (seed, track))
+
+    def test_position_only_converges(self):
+        # Without gs/track the filter starts from zero velocity and a wide
+        # prior, so it takes a few reports before the closing is trusted.
+        for seed in self.SEEDS:
+            run = fly(seed, 6.0, 0.0, 270.0, 100, velocity=False)
+            self.assertLessEqual(first_flagged(run), 6)
+            self.assertLess(rms(run, skip=10), 15.0)
+
+    def test_repeats_and_gaps(self):
+        store = TrackStore(1)
+        rec = store.claim("a1b2c3", T0)
+        store.filter_update(rec, 40.0, -74.9, 100.0, 270.0, T0)
+        store.filter_update(rec, 40.0, -74.9, 100.0, 270.0, T0 + 1)
+        p = store.kpx[rec]
+        # The same report again, or an older one, is not fused twice.
+        store.filter_update(rec, 40.0, -74.9, 100.0, 270.0, T0 + 1)
+        store.filter_update(rec, 40.0, -74.9, 100.0, 270.0, T0 + 0.5)
+        self.assertEqual((store.kpx[rec], store.kf_t[rec]), (p, T0 + 1))
+        # Past the reset gap the estimate is gone and the filter restarts.
+        late = T0 + 2 + KF_RESET_GAP_SEC
+        self.assertEqual(store.range_rate(rec, MY_LAT, MY_LON, late), (None, None))
+        store.filter_update(rec, 40.0, -74.8, 100.0, 90.0, late)
+        self.assertEqual((store.org_lon[rec], store.kx[rec]), (-74.8, 0.0))
+        closing, _ = store.range_rate(rec, MY_LAT, MY_LON, late)
+        self.assertLess(closing, -100)
+
+
+if __name__ == "__main__":
+    unittest.main()
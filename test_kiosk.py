@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Kiosk framebuffer: blits checked byte for byte in a file-backed framebuffer."""
+import os, tempfile, unittest
+from unittest import mock
+
+import adsb_kiosk
+from adsb_kiosk import np, Framebuffer, FBIOGET_VSCREENINFO, FBIOGET_FSCREENINFO
+
+W, H = 40, 30
+
+
+def _rgb565(rgb):
+    px = rgb.astype(np.uint16)
+    return (px[..., 0] >> 3 << 11) | (px[..., 1] >> 2 << 5) | (px[..., 2] >> 3)
+
+
+def _device(xres, yres, bpp, line_length, yres_virtual=None, xoffset=0, yoffset=0,
+            red_offset=16):
+    """An ioctl that answers the screeninfo queries like a real fbdev."""
+    def ioctl(fd, request, info):
+        if request == FBIOGET_VSCREENINFO:
+            info.xres, info.yres, info.bits_per_pixel = xres, yres, bpp
+            info.xres_virtual, info.yres_virtual = xres, yres_virtual or yres
+            info.xoffset, info.yoffset = xoffset, yoffset
+            info.red.offset = red_offset
+        elif request == FBIOGET_FSCREENINFO:
+            info.line_length = line_length
+        return 0
+    return mock.patch.object(adsb_kiosk.fcntl, "ioctl", ioctl)
+
+
+@unittest.skipIf(np is None, "the kiosk needs numpy")
+class FramebufferTest(unittest.TestCase):
+
+    def setUp(self):
+        fd, self.path = tempfile.mkstemp(prefix="adsb-test-fb-")
+        os.close(fd)
+        self.back = np.random.default_rng(1).integers(0, 256, (H, W, 3), dtype=np.uint8)
+        self.fb = None
+
+    def tearDown(self):
+        if self.fb:
+            self.fb.close()
+        os.unlink(self.path)
+
+    def _screen(self, stride, rows):
+        with open(self.path, "rb") as fh:
+            data = fh.read()
+        self.assertEqual(len(data), stride * rows)
+        return np.frombuffer(data, np.uint8).reshape(rows, stride)
+
+    def test_file_32bpp(self):
+        self.fb = Framebuffer(self.path, (W, H), 32)
+        self.fb.blit(self.back, [(0, 0, W, H)])
+        px = self._screen(W * 4, H).reshape(H, W, 4)
+        np.testing.assert_array_equal(px[..., 2::-1], self.back)      # B, G, R, X
+        self.assertTrue((px[..., 3] == 255).all())
+
+    def test_file_16bpp(self):
+        self.fb = Framebuffer(self.path, (W, H), 16)
+        self.fb.blit(self.back, [(0, 0, W, H)])
+        px = self._screen(W * 2, H).view("<u2")
+        np.testing.assert_array_equal(px, _rgb565(self.back))
+
+    def test_blit_touches_only_its_boxes(self):
+        self.fb = Framebuffer(self.path, (W, H), 32)
+        boxes = [(3, 2, 11, 9), (30, 20, 40, 30)]
+        self.fb.blit(self.back, boxes)
+        px = self._screen(W * 4, H).reshape(H, W, 4)
+        inside = np.zeros((H, W), bool)
+        for x0, y0, x1, y1 in boxes:
+            inside[y0:y1, x0:x1] = True
+            np.testing.assert_array_equal(px[y0:y1, x0:x1, 2::-1], self.back[y0:y1, x0:x1])
+        self.assertFalse(px[~inside].any())
+
+    def test_device_draws_on_the_visible_page(self):
+        # Double-buffered and panned: the second page is on show, four pixels
+        # in, and every line is padded past the visible width.
+        for bpp, red_offset in ((32, 0), (32, 16), (16, 11)):
+            with self.subTest(bpp=bpp, red_offset=red_offset):
+                stride = (W + 8) * bpp // 8
+                os.truncate(self.path, stride * 2 * H)
+                with open(self.path, "r+b") as fh:
+                    fh.write(bytes(stride * 2 * H))
+                with _device(W, H, bpp, stride, yres_virtual=2 * H, xoffset=4, yoffset=H,
+                             red_offset=red_offset):
+                    fb = Framebuffer(self.path)
+                self.assertEqual((fb.width, fb.height, fb.bpp, fb.stride), (W, H, bpp, stride))
+                fb.blit(self.back, [(0, 0, W, H)])
+                fb.close()
+                screen = self._screen(stride, 2 * H)
+                x0, x1 = 4 * bpp // 8, (4 + W) * bpp // 8
+                shown = screen[H:, x0:x1]
+                if bpp == 32:
+                    order = slice(None, 3) if red_offset == 0 else slice(2, None, -1)
+                    np.testing.assert_array_equal(shown.reshape(H, W, 4)[..., order], self.back)
+                else:
+                    np.testing.assert_array_equal(shown.copy().view("<u2"), _rgb565(self.back))
+                # The hidden page and the padding are left alone.
+                self.assertFalse(screen[:H].any())
+                self.assertFalse(screen[H:, :x0].any() or screen[H:, x1:].any())
+
+    def test_unsupported_depth(self):
+        os.truncate(self.path, W * 3 * H)
+        with _device(W, H, 24, W * 3), self.assertRaises(ValueError):
+            Framebuffer(self.path)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""OrbitTracker checked decision-for-decision against the deque tracker it replaced."""
+import math, random, unittest
+from collections import deque
+
+from adsb_engine import (OrbitTracker, ORBIT_TIME_WINDOW, ORBIT_HEADING_THRESHOLD,
+                         ORBIT_MIN_TURN_RATE_DPS, ORBIT_MIN_SAMPLE_SEC)
+
+
+class DequeOrbitTracker:
+    """The original tracker, kept verbatim as the reference: a deque of
+    (time, heading) per hex, re-summed in full on every update."""
+
+    def __init__(self):
+        self._history = {}
+
+    def update(self, hexid, track, now):
+        if track is None:
+            return False
+        if hexid not in self._history:
+            self._history[hexid] = deque()
+        self._history[hexid].append((now, float(track)))
+        cutoff = now - ORBIT_TIME_WINDOW
+        while self._history[hexid] and self._history[hexid][0][0] < cutoff:
+            self._history[hexid].popleft()
+        entries = self._history[hexid]
+        if len(entries) < 6:
+            return False
+        time_span = entries[-1][0] - entries[0][0]
+        if time_span < 10:
+            return False
+        total_turn = 0.0
+        prev = entries[0][1]
+        for _, heading in list(entries)[1:]:
+            diff = (heading - prev + 180) % 360 - 180
+            total_turn += diff
+            prev = heading
+        if abs(total_turn) < ORBIT_HEADING_THRESHOLD:
+            return False
+        # Require a sustained turn rate so normal gradual course changes
+        # don't accumulate enough degrees to look like an orbit.
+        return (abs(total_turn) / time_span) >= ORBIT_MIN_TURN_RATE_DPS
+
+    def cleanup(self, active_hexids):
+        for hexid in list(self._history.keys()):
+            if hexid not in active_hexids:
+                del self._history[hexid]
+
+
+class _Flight:
+    """One synthetic aircraft: a heading program plus gaps in its reports."""
+
+    KINDS = ("steady", "orbit", "reversal", "noisy", "slow_turn", "spiral")
+
+    def __init__(self, rnd, kind):
+        self.rnd = rnd
+        self.kind = kind
+        self.heading = rnd.uniform(0, 360)
+        self.rate = rnd.choice((-1, 1)) * rnd.uniform(1.0, 6.0)
+        self.flip_every = rnd.uniform(20, 90)
+        self.drop = rnd.uniform(0.0, 0.3)       # chance a tick carries no track
+        self.age = 0.0
+
+    def step(self, dt):
+        r = self.rnd
+        self.age += dt
+        if self.kind == "steady":
+            self.heading += r.gauss(0, 1.0)
+        elif self.kind == "orbit":
+            self.heading += self.rate * dt + r.gauss(0, 2.0)
+        elif self.kind == "reversal":
+            if self.age % (2 * self.flip_every) > self.flip_every:
+                self.heading -= self.rate * dt
+            else:
+                self.heading += self.rate * dt
+        elif self.kind == "noisy":
+            self.heading += r.gauss(0, 25.0)
+        elif self.kind == "slow_turn":
+            self.heading += 1.2 * dt
+        else:
+            self.heading += self.rate * dt * min(1.0, self.age / 60)
+        self.heading %= 360
+        if r.random() < self.drop:
+            return None
+        # readsb reports track to 0.1 deg, sometimes as an integer.
+        return round(self.heading, 1) if r.random() < 0.8 else int(self.heading)
+
+
+def _drive(seed, ticks, n_flights, check, reference=DequeOrbitTracker):
+    """Feed both trackers the same randomised traffic; check(old, new, hexid, now)."""
+    rnd = random.Random(seed)
+    old, new = reference(), OrbitTracker(n_flights * 2)
+    free = list(range(n_flights * 2))
+    recs, flights = {}, {}
+    serial = 0
+    now = 1_700_000_000.0
+    decisions = 0
+    for _ in range(ticks):
+        # Uneven tick spacing, never closer than the decimation floor.
+        now += rnd.uniform(ORBIT_MIN_SAMPLE_SEC, 2.5)
+        while len(flights) < n_flights:
+            serial += 1
+            hexid = "%06x" % serial
+            flights[hexid] = _Flight(rnd, rnd.choice(_Flight.KINDS))
+            recs[hexid] = free.pop()
+            new.reset(recs[hexid])
+        # Churn: a few tracks leave for good; others skip this snapshot.
+        for hexid in [h for h in flights if rnd.random() < 0.002]:
+            del flights[hexid]
+        active = set()
+        for hexid, fl in flights.items():
+            track = fl.step(now - getattr(fl, "last", now - 1.0))
+            fl.last = now
+            if rnd.random() < 0.01:
+                continue                        # missing from this snapshot
+            active.add(hexid)
+            a = old.update(hexid, track, now)
+            b = new.update(recs[hexid], track, now)
+            check(a, b, hexid, now)
+            decisions += a
+        old.cleanup(active)
+        # The engine forgets a record once it leaves the table; mirror the
+        # deque tracker dropping history for every hex not in the snapshot.
+        for hexid in [h for h in recs if h not in active]:
+            if hexid in flights:
+                new.reset(recs[hexid])
+            else:
+                free.append(recs.pop(hexid))
+    return decisions
+
+
+class OrbitEquivalenceTest(unittest.TestCase):
+
+    def test_same_decisions_as_deque_tracker(self):
+        mismatches, ties = [], []
+        olds = []
+
+        def check(a, b, hexid, now):
+            if a == b:
+                return
+            # 0.1-degree headings can sum to exactly the threshold, where the
+            # reference's float sum lands on either side by rounding.  There
+            # the new tracker, which sums whole microdegrees, must count it as
+            # reaching the threshold.
+            entries = list(olds[-1]._history[hexid])
+            turn = abs(math.fsum((h1 - h0 + 180) % 360 - 180
+                                 for (_, h0), (_, h1) in zip(entries, entries[1:])))
+            span = entries[-1][0] - entries[0][0]
+            exact = len(entries) >= 6 and span >= 10 and turn / span >= ORBIT_MIN_TURN_RATE_DPS
+            if abs(turn - ORBIT_HEADING_THRESHOLD) < 1e-6 and b == exact:
+                ties.append(hexid)
+            else:
+                mismatches.append((hexid, now, a, b))
+
+        class Reference(DequeOrbitTracker):
+            def __init__(self):
+                super().__init__()
+                olds.append(self)
+        total = 0
+        for seed in range(4):
+            total += _drive(seed, 600, 60, check, Reference)
+        self.assertEqual(mismatches[:5], [])
+        self.assertLess(len(ties), 5, ties)
+        # The traffic must actually exercise both outcomes.
+        self.assertGreater(total, 1000)
+
+    def test_samples_inside_decimation_floor_are_skipped(self):
+        t = OrbitTracker(1)
+        old = DequeOrbitTracker()
+        now = 0.0
+        for k in range(40):
+            now += 1.0
+            self.assertEqual(t.update(0, k * 10.0, now), old.update("a", k * 10.0, now))
+        self.assertTrue(t.update(0, 390.0, now + 0.1))
+        # A burst of pushed headings changes nothing until the floor has passed.
+        self.assertTrue(t.update(0, 0.0, now + 0.2))
+        self.assertEqual(t._count[0], 40)
+
+    def test_full_ring_drops_oldest(self):
+        # At the decimation floor the window fits the ring; a short one fills.
+        class Short(OrbitTracker):
+            RING = 16
+        t = Short(2)
+        for k in range(Short.RING + 10):
+            t.update(1, (k * 3.1) % 360, k * ORBIT_MIN_SAMPLE_SEC)
+        self.assertEqual(t._count[1], Short.RING)
+        span = (t._t[Short.RING + (t._head[1] + t._count[1] - 1) % Short.RING]
+                - t._t[Short.RING + t._head[1]])
+        self.assertAlmostEqual(span, (Short.RING - 1) * ORBIT_MIN_SAMPLE_SEC)
+        # The running sum matches the samples left in the ring, exactly.
+        self.assertEqual(t._turn[1], 3.1 * (Short.RING - 1) * Short.UNIT)
+        self.assertEqual(t._count[0], 0)
+
+
+if __name__ == "__main__":
+    unittest.main()